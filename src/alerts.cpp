@@ -0,0 +1,70 @@
+#include "alerts.h"
+
+bool alertValid(const AlertRule& rule) {
+  if (rule.coin > 1 || !isfinite(rule.level)) return false;
+  switch (rule.type) {
+    case ALERT_ABOVE:
+    case ALERT_BELOW:
+      return rule.level > 0;   // цена 0 — правило, которое никогда не сработает
+    case ALERT_CHANGE:
+      return rule.param >= 1 && rule.param <= ALERT_CHANGE_MAX_MINUTES && rule.level > 0;
+    case ALERT_CROSS_EMA:
+      return rule.param < EMA_COUNT;
+    default:
+      return false;
+  }
+}
+
+bool alertCheck(const AlertRule& rule, const PriceStats& s, float& metric) {
+  if (s.size < 2) return false;
+
+  float now  = statsValue(s, 0);
+  float prev = statsValue(s, 1);
+  metric = now;
+
+  switch (rule.type) {
+    case ALERT_ABOVE:
+      return prev <= rule.level && now > rule.level;
+
+    case ALERT_BELOW:
+      return prev >= rule.level && now < rule.level;
+
+    case ALERT_CHANGE: {
+      uint32_t window = rule.param * 60u;
+      metric = statsChange(s, window, 0);
+      if (isnan(metric)) return false;
+      // На предыдущем тике окна могло ещё не быть — тогда считаем, что порог не был превышен
+      float before = statsChange(s, window, 1);
+      if (isnan(before)) before = 0.0f;
+      return fabsf(metric) >= rule.level && fabsf(before) < rule.level;
+    }
+
+    case ALERT_CROSS_EMA: {
+      int i = rule.param;
+      metric = s.ema[i];
+      if (s.size < 3) return false;  // на втором тике EMA ещё равна первой цене
+      return (now > s.ema[i]) != (prev > s.emaPrev[i]);
+    }
+  }
+  return false;
+}
+
+void alertDescribe(const AlertRule& rule, char* out, size_t outLen) {
+  switch (rule.type) {
+    case ALERT_ABOVE:
+      snprintf(out, outLen, "> %.6g", rule.level);
+      break;
+    case ALERT_BELOW:
+      snprintf(out, outLen, "< %.6g", rule.level);
+      break;
+    case ALERT_CHANGE:
+      snprintf(out, outLen, "%.1f%% / %um", rule.level, rule.param);
+      break;
+    case ALERT_CROSS_EMA:
+      snprintf(out, outLen, "x EMA%u", rule.param);
+      break;
+    default:
+      strlcpy(out, "-", outLen);
+      break;
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+#include "priceStats.h"
+
+// Правила оповещений. Проверяются на каждом новом тике по кэшу PriceStats:
+// сравниваются только последняя и предыдущая точки, историю не сканируем
+// (окно изменения ищется двоичным поиском по времени).
+// Все правила срабатывают по фронту — один раз при переходе условия в "истину".
+
+enum AlertType : uint8_t {
+  ALERT_NONE      = 0,
+  ALERT_ABOVE     = 1,   // цена поднялась выше level
+  ALERT_BELOW     = 2,   // цена опустилась ниже level
+  ALERT_CHANGE    = 3,   // |изменение за param минут| >= level %
+  ALERT_CROSS_EMA = 4    // цена пересекла EMA с индексом param
+};
+
+// 8 байт на правило — хранится в EEPROM как есть
+struct __attribute__((packed)) AlertRule {
+  uint8_t  type;
+  uint8_t  coin;    // 0 — crypto1, 1 — crypto2
+  uint16_t param;
+  float    level;
+};
+
+const int ALERT_MAX_RULES = 8;
+const int ALERT_CHANGE_MAX_MINUTES = 24 * 60;  // дальше истории нет
+
+// Проверить правило на последнем тике; metric — значение, по которому сработало
+bool alertCheck(const AlertRule& rule, const PriceStats& s, float& metric);
+
+// Правило корректно (тип, окно и индекс EMA в допустимых пределах, уровень —
+// конечное число, для цены — больше нуля)
+bool alertValid(const AlertRule& rule);
+
+// Короткое описание для OLED и веба: "> 65000", "5.0% / 60m", "x EMA1"
+void alertDescribe(const AlertRule& rule, char* out, size_t outLen);
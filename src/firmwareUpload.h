@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+
+// Приём прошивки кусками поверх Updater из ядра (в нативных тестах — поверх
+// эмулятора flash с тем же интерфейсом: begin, setMD5, write, end).
+//
+// "Начали" и "пока всё хорошо" хранятся отдельно: если begin() прошёл, end()
+// вызывается всегда — и после ошибки записи или MD5. Иначе Updater остаётся
+// запущенным и следующая загрузка упирается в "already running" до перезагрузки.
+template <class Flash>
+class FirmwareUpload {
+public:
+  explicit FirmwareUpload(Flash& flash) : _flash(flash) {}
+
+  // md5 — ожидаемая hex-сумма загружаемого файла или nullptr
+  bool start(size_t maxSize, const char* md5) {
+    if (_begun) _flash.end();  // предыдущая загрузка оборвалась без END/ABORTED
+    _begun = _flash.begin(maxSize);
+    _ok    = _begun;
+    if (_ok && md5) _ok = _flash.setMD5(md5);
+    return _ok;
+  }
+
+  bool write(uint8_t* data, size_t len) {
+    if (_ok && _flash.write(data, len) != len) _ok = false;
+    return _ok;
+  }
+
+  // end(true) ставит образ на установку, проверив MD5 и заголовок.
+  // После ошибки — end() без true: недописанный образ сбрасывается, а не ставится.
+  bool finish() {
+    if (_begun) {
+      bool ended = _ok ? _flash.end(true) : _flash.end();
+      _ok    = _ok && ended;
+      _begun = false;
+    } else {
+      _ok = false;
+    }
+    return _ok;
+  }
+
+  void abort() {
+    if (_begun) _flash.end();
+    _begun = false;
+    _ok    = false;
+  }
+
+  bool ok() const    { return _ok; }
+  bool begun() const { return _begun; }
+
+private:
+  Flash& _flash;
+  bool   _begun = false;
+  bool   _ok    = false;
+};
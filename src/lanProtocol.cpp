@@ -0,0 +1,53 @@
+#include "lanProtocol.h"
+
+static const char LAN_MAGIC[4] = { 'O', 'C', 'S', '1' };
+
+void lanReset(LanState& st) {
+  memset(&st, 0, sizeof(st));
+}
+
+void lanEncode(LanSnapshot& snap) {
+  memcpy(snap.magic, LAN_MAGIC, sizeof(LAN_MAGIC));
+}
+
+bool lanDecode(LanSnapshot& snap) {
+  if (memcmp(snap.magic, LAN_MAGIC, sizeof(LAN_MAGIC)) != 0) return false;
+
+  // Строки из сети — не доверяем терминаторам
+  snap.symbol1[sizeof(snap.symbol1) - 1] = 0;
+  snap.symbol2[sizeof(snap.symbol2) - 1] = 0;
+  snap.city[sizeof(snap.city) - 1]       = 0;
+  snap.weather[sizeof(snap.weather) - 1] = 0;
+  return true;
+}
+
+void lanLeaderUpdate(LanState& st, const LanSnapshot& snap, uint32_t nowMs) {
+  st.last     = snap;
+  st.last.seq = ++st.seq;
+  st.haveLast = true;
+  st.freshMs  = nowMs;
+}
+
+bool lanFollowerAccept(LanState& st, const LanSnapshot& snap, uint32_t nowMs) {
+  // time тоже сравниваем: после перезагрузки лидер считает seq с 1 заново
+  bool isNew = !st.haveLast || snap.seq != st.last.seq || snap.time != st.last.time;
+  st.last     = snap;
+  st.haveLast = true;
+  if (isNew) st.freshMs = nowMs;
+  return isNew;
+}
+
+bool lanFresh(const LanState& st, uint32_t nowMs) {
+  return st.haveLast && nowMs - st.freshMs < LAN_LEADER_TIMEOUT;
+}
+
+bool lanCoversCrypto(const LanState& st, uint32_t nowMs, const char* symbol1, const char* symbol2) {
+  return lanFresh(st, nowMs) &&
+         strcmp(st.last.symbol1, symbol1) == 0 &&
+         strcmp(st.last.symbol2, symbol2) == 0;
+}
+
+bool lanCoversWeather(const LanState& st, uint32_t nowMs, const char* city) {
+  return lanFresh(st, nowMs) && st.last.weatherValid &&
+         strcasecmp(st.last.city, city) == 0;
+}
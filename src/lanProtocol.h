@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+
+// Формат снимка и логика "жив ли лидер" — без сети, чтобы гонять в нативных
+// тестах. Отправка и приём по UDP — в lanShare.
+
+// Формат пакета (little-endian, без выравнивания)
+struct __attribute__((packed)) LanSnapshot {
+  char     magic[4];        // "OCS1"
+  uint32_t seq;             // растёт с каждым новым снимком, повторы — heartbeat
+  uint32_t time;            // unix-время цен
+  char     symbol1[16];
+  float    price1;
+  char     symbol2[16];
+  float    price2;
+  uint8_t  weatherValid;
+  char     city[32];
+  float    temperature;
+  char     weather[24];
+};
+
+const uint32_t LAN_HEARTBEAT_INTERVAL = 30000;   // лидер повторяет снимок
+const uint32_t LAN_LEADER_TIMEOUT     = 360000;  // нет новых данных дольше — качаем сами
+
+// Последний снимок узла: отправленный (лидер) или принятый (ведомый).
+// freshMs — когда снимок был новым: успешное обновление у лидера,
+// новый seq у ведомого. Повторы-heartbeat его не сдвигают.
+struct LanState {
+  LanSnapshot last;
+  bool        haveLast;
+  uint32_t    seq;          // лидер: номер последнего снимка
+  uint32_t    freshMs;
+};
+
+void lanReset(LanState& st);
+
+// Перед отправкой / после приёма: магия, терминаторы строк
+void lanEncode(LanSnapshot& snap);
+bool lanDecode(LanSnapshot& snap);
+
+// Лидер: снимок после успешного обновления, получает следующий seq
+void lanLeaderUpdate(LanState& st, const LanSnapshot& snap, uint32_t nowMs);
+
+// Ведомый: принять снимок; true — новые данные, false — повтор
+bool lanFollowerAccept(LanState& st, const LanSnapshot& snap, uint32_t nowMs);
+
+// Данные свежие: лидеру — есть что повторять, ведомому — лидер жив
+bool lanFresh(const LanState& st, uint32_t nowMs);
+
+// Свежий снимок лидера покрывает наши монеты / наш город
+bool lanCoversCrypto(const LanState& st, uint32_t nowMs, const char* symbol1, const char* symbol2);
+bool lanCoversWeather(const LanState& st, uint32_t nowMs, const char* city);
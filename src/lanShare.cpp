@@ -0,0 +1,42 @@
+#include "lanShare.h"
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+
+static const IPAddress LAN_GROUP(239, 255, 77, 77);
+
+static WiFiUDP lanUdp;
+static LanMode lanMode = LAN_STANDALONE;
+
+void lanBegin(LanMode mode) {
+  if (lanMode == LAN_FOLLOWER) lanUdp.stop();
+  lanMode = mode;
+  if (lanMode == LAN_FOLLOWER) {
+    lanUdp.beginMulticast(WiFi.localIP(), LAN_GROUP, LAN_PORT);
+  }
+}
+
+void lanSend(const LanSnapshot& snap) {
+  if (lanMode != LAN_LEADER) return;
+
+  LanSnapshot packet = snap;
+  lanEncode(packet);
+
+  // TTL 1 — дальше своей подсети не уходит
+  lanUdp.beginPacketMulticast(LAN_GROUP, LAN_PORT, WiFi.localIP(), 1);
+  lanUdp.write((const uint8_t*)&packet, sizeof(packet));
+  lanUdp.endPacket();
+}
+
+bool lanReceive(LanSnapshot& out) {
+  if (lanMode != LAN_FOLLOWER) return false;
+
+  int size = lanUdp.parsePacket();
+  if (size <= 0) return false;
+  if (size != (int)sizeof(LanSnapshot)) {
+    lanUdp.flush();
+    return false;
+  }
+
+  lanUdp.read((uint8_t*)&out, sizeof(out));
+  return lanDecode(out);
+}
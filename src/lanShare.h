@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+#include "lanProtocol.h"
+
+// Раздача данных по локалке: один узел (лидер) ходит в Binance/OpenWeather
+// и рассылает снимок по UDP multicast, остальные (ведомые) берут цены из него.
+
+enum LanMode : uint8_t {
+  LAN_STANDALONE = 0,   // всё качаем сами, сеть не слушаем
+  LAN_LEADER     = 1,   // качаем сами и рассылаем снимки
+  LAN_FOLLOWER   = 2    // берём снимки лидера, сами качаем только без него
+};
+
+const uint16_t LAN_PORT = 4210;
+
+void lanBegin(LanMode mode);
+void lanSend(const LanSnapshot& snap);
+
+// Неблокирующий приём; true — пришёл корректный снимок
+bool lanReceive(LanSnapshot& out);
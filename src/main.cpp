@@ -2,22 +2,25 @@
 #include <GyverOLED.h>
 #include <ESP8266WiFi.h>
 #include <WiFiManager.h>
-#include <NTPClient.h>
-#include <WiFiUdp.h>
 #include <ESP8266WebServer.h>
 #include <ESP8266HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoOTA.h>
+#include <Updater.h>
 #include <ArduinoJson.h>
 #include <EEPROM.h>
 
 #include <bootImage.h>
+#include <priceStats.h>
+#include <timeService.h>
+#include <scheduler.h>
+#include <lanShare.h>
+#include <alerts.h>
+#include <slides.h>
+#include <firmwareUpload.h>
 
 GyverOLED<SSD1306_128x64, OLED_BUFFER> oled;
 
-WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, "pool.ntp.org", 10800);  // смещение +3 часа
-
 ESP8266WebServer server(80);
 
 // ======= EEPROM =======
@@ -35,12 +38,27 @@ const int EEPROM_CR1_LEN       = 16;
 const int EEPROM_CR2_OFFSET    = 140;  // "ETHUSDT"
 const int EEPROM_CR2_LEN       = 16;
 
+const int EEPROM_TZ_OFFSET     = 160;  // POSIX TZ, "<+03>-3"
+const int EEPROM_TZ_LEN        = 40;
+
+const int EEPROM_LAN_OFFSET    = 200;  // LanMode, 1 байт
+
+const int EEPROM_ALERTS_OFFSET = 208;  // ALERT_MAX_RULES * 8 байт
+
+const int EEPROM_OTA_PASS_OFFSET = 280;  // пароль прошивки (HTTP и espota)
+const int EEPROM_OTA_PASS_LEN    = 32;
+
 // ======= КРИПТА (Binance) =======
-String crypto1Symbol = "BTCUSDT";
-String crypto2Symbol = "ETHUSDT";
+char crypto1Symbol[EEPROM_CR1_LEN] = "BTCUSDT";
+char crypto2Symbol[EEPROM_CR2_LEN] = "ETHUSDT";
+
+// Базовые активы ("BTC"), считаются один раз при смене символа, а не каждый кадр
+char crypto1Base[EEPROM_CR1_LEN] = "BTC";
+char crypto2Base[EEPROM_CR2_LEN] = "ETH";
 
-float crypto1History[5] = {0};
-float crypto2History[5] = {0};
+// История + статистика (min/max/EMA/волатильность), обновляются за O(1) на тик
+PriceStats crypto1Stats;
+PriceStats crypto2Stats;
 
 // ===== СПИСОК ВАЛЮТ ДЛЯ DROPDOWN =====
 struct CoinOption {
@@ -64,19 +82,84 @@ const CoinOption coinOptions[] = {
 const int coinOptionsCount = sizeof(coinOptions) / sizeof(coinOptions[0]);
 
 // ======= ПОГОДА =======
-String weatherCity   = "Hrodna";
-String weatherApiKey = "";      // задаётся с веба
-String weatherUrl    = "";
+char weatherCity[EEPROM_CITY_LEN]  = "Hrodna";
+char weatherApiKey[EEPROM_API_LEN] = "";      // задаётся с веба
+char weatherUrl[192]               = "";
+
+// ======= ВРЕМЯ =======
+char timeZone[EEPROM_TZ_LEN] = "<+03>-3";  // UTC+3 по умолчанию
+char clockText[6]            = "--:--";    // HH:MM, обновляется раз в минуту
 
 // ======= ПРОЧЕЕ =======
-float temperature         = 0.0;
-String weatherDescription = "";
+float temperature           = 0.0;
+char  weatherDescription[24] = "";
+bool  haveWeather            = false;  // есть ли погода (своя или от лидера)
+
+// ======= ЛОКАЛКА (лидер/ведомые) =======
+LanMode     lanMode = LAN_STANDALONE;
+LanState    lanState;                // последний снимок и когда он был новым
 
-unsigned long lastUpdate      = 0;
-unsigned long lastSlideChange = 0;
+// Общий буфер для отдачи страниц кусками (без сборки String целиком)
+const size_t HTTP_CHUNK_SIZE = 512;
+char   httpChunk[HTTP_CHUNK_SIZE];
+size_t httpChunkLen = 0;
+
+const unsigned long dataInterval  = 300000;  // данные раз в 5 минут
+const unsigned long firstFetchTimeout = 15000;  // первый запрос ждёт SNTP не дольше, мс
 const unsigned long slideInterval = 8000;
+const unsigned long netPollInterval = 10;    // OTA + HTTP
 int currentSlide = 0;
-const int totalSlides = 5;
+bool displayDirty = true;  // перерисовывать OLED только когда что-то изменилось
+
+// ======= ЗАМЕРЫ ОТРИСОВКИ =======
+const int OLED_W = 128;
+const int OLED_H = 64;
+const uint32_t OLED_FRAME_BYTES = OLED_W * OLED_H / 8;  // update() шлёт весь буфер
+
+struct SlideTiming {
+  uint32_t frames;
+  uint32_t drawUs;     // последний кадр: рисование в буфер
+  uint32_t updateUs;   // последний кадр: отправка по I2C
+  uint32_t maxUs;      // худший кадр целиком
+  uint16_t pixels;     // горящих пикселей в последнем кадре
+};
+SlideTiming slideTiming[totalSlides + 1];  // + слайд оповещения
+uint32_t    oledBytesPushed = 0;
+
+// ======= OTA ПО HTTP =======
+// Без пароля /update не принимает прошивку: multipart-POST — "простой" запрос,
+// его может отправить любая страница, открытая в браузере в этой сети
+const char* OTA_USER = "admin";
+char otaPassword[EEPROM_OTA_PASS_LEN] = "";
+FirmwareUpload<UpdaterClass> otaHttp(Update);
+int  otaHttpPercent = -1;     // последний показанный на OLED процент
+bool otaHttpAuthorized = false;
+
+// ======= ОПОВЕЩЕНИЯ =======
+AlertRule alertRules[ALERT_MAX_RULES];
+const unsigned long alertHoldInterval = 2 * slideInterval;  // сколько держать слайд
+
+int   alertLastRule   = -1;
+float alertLastPrice  = 0;
+float alertLastMetric = 0;
+
+// Задержка от тика до кадра на OLED
+uint32_t alertArrivedUs    = 0;   // micros() прихода цены, на которой сработало правило
+uint32_t alertLatencyUs    = 0;
+uint32_t alertLatencyMaxUs = 0;
+
+// Подписчики Server-Sent Events (/events)
+const int  SSE_MAX_CLIENTS = 4;
+WiFiClient sseClients[SSE_MAX_CLIENTS];
+
+// ======= ЗАДАЧИ ПЛАНИРОВЩИКА =======
+int taskIdClock   = -1;
+int taskIdData    = -1;
+int taskIdSlides  = -1;
+int taskIdDisplay = -1;
+bool firstFetchDone = false;  // первый запрос данных после старта уже был
+bool clockWasSynced = false;
+uint32_t syncWaitStartMs = 0; // когда запущен SNTP — отсюда считается firstFetchTimeout
 
 bool invertMode    = false;
 int  contrastValue = 127;
@@ -88,22 +171,68 @@ void saveSettings();
 void handleRoot();
 bool updateData();
 void displayData();
+bool oledPixel(int x, int y);
+uint16_t countLitPixels();
 
-float getCryptoRate(const String& symbol);
+float getCryptoRate(const char* symbol, uint32_t& arrivedUs);
 void getWeather();
+void refreshWeather();
+void buildWeatherUrl();
 
 void handleSettingsUpdate();
 void handleThemeUpdate();
 void handleContrastUpdate();
 void handleApiKeyUpdate();
 void handleCryptoUpdate();
-
-void updateHistory(float history[], float newValue);
-void calcMinMax(const float *data, int n, float &minVal, float &maxVal);
-
-void saveStringToEEPROM(int offset, int maxLen, const String& value);
-String readStringFromEEPROM(int offset, int maxLen);
-String getBaseAsset(const String& symbol);
+void handleTimezoneUpdate();
+void handleLanModeUpdate();
+void handleEvents();
+void handleAlertAdd();
+void handleAlertClear();
+
+void onPriceTick(int coin, uint32_t arrivedUs);
+void alertPublish();
+
+void handleTasks();
+void handleHistoryCsv();
+void handleHistoryBin();
+void handleFramePbm();
+void handleUpdateUpload();
+void handleUpdateDone();
+void handleOtaPasswordUpdate();
+bool otaAuthenticated();
+void showUpdateProgress(const char* status, int percent);
+
+void onMinuteChanged(const struct tm& local);
+void onTimeAdjusted();
+void onFirstSync();
+void requestRedraw();
+
+uint32_t taskNetwork();
+uint32_t taskClock();
+uint32_t taskData();
+uint32_t taskSlides();
+uint32_t taskDisplay();
+uint32_t taskLanHeartbeat();
+
+void lanPublish();
+void onLanSnapshot(const LanSnapshot& snap, uint32_t arrivedUs);
+bool leaderAlive();
+bool leaderCoversCrypto();
+bool leaderCoversWeather();
+
+void saveStringToEEPROM(int offset, int maxLen, const char* value);
+void readStringFromEEPROM(int offset, int maxLen, char* out);
+void getBaseAsset(const char* symbol, char* out, size_t outLen);
+void updateBaseAssets();
+void copyArgTrimmed(const char* name, char* out, size_t outLen);
+
+void pageBegin(const char* contentType);
+void pageFlush();
+void pageWrite(const void* data, size_t len);
+void pagePrint(const char* text);
+void pagePrintf(const char* fmt, ...);
+void pageEnd();
 
 // ================== SETUP ==================
 void setup() {
@@ -111,10 +240,11 @@ void setup() {
   EEPROM.begin(EEPROM_SIZE);
 
   loadSettings();
+  statsReset(crypto1Stats);
+  statsReset(crypto2Stats);
 
   // Сборка URL погоды (если будет ключ)
-  weatherUrl = "https://api.openweathermap.org/data/2.5/weather?q=" +
-               weatherCity + "&appid=" + weatherApiKey + "&units=metric";
+  buildWeatherUrl();
 
   oled.init();
   oled.invertDisplay(invertMode);
@@ -136,10 +266,14 @@ void setup() {
   WiFiManager wifiManager;
   wifiManager.autoConnect("NodeMCU-Finance");
 
-  timeClient.begin();
+  timeOnMinute(onMinuteChanged);
+  timeOnAdjust(onTimeAdjusted);
+  timeBegin(timeZone);
+  syncWaitStartMs = millis();   // autoConnect мог идти минуты — ждём SNTP от этой точки
 
   // OTA
   ArduinoOTA.setHostname("NodeMCU-Finance");
+  if (otaPassword[0]) ArduinoOTA.setPassword(otaPassword);
   ArduinoOTA.begin();
 
   // HTTP сервер
@@ -154,6 +288,17 @@ void setup() {
   server.on("/contrast", HTTP_POST, handleContrastUpdate);
   server.on("/apikey",   HTTP_POST, handleApiKeyUpdate);
   server.on("/crypto",   HTTP_POST, handleCryptoUpdate);
+  server.on("/timezone", HTTP_POST, handleTimezoneUpdate);
+  server.on("/lan",      HTTP_POST, handleLanModeUpdate);
+  server.on("/events",   HTTP_GET,  handleEvents);
+  server.on("/alerts",       HTTP_POST, handleAlertAdd);
+  server.on("/alerts/clear", HTTP_POST, handleAlertClear);
+  server.on("/tasks",    handleTasks);
+  server.on("/history.csv", HTTP_GET, handleHistoryCsv);
+  server.on("/history.bin", HTTP_GET, handleHistoryBin);
+  server.on("/frame.pbm",   HTTP_GET, handleFramePbm);
+  server.on("/update",      HTTP_POST, handleUpdateDone, handleUpdateUpload);
+  server.on("/otapass",     HTTP_POST, handleOtaPasswordUpdate);
   server.begin();
 
   oled.clear();
@@ -161,55 +306,109 @@ void setup() {
   oled.print("WiFi Connected!");
   oled.update();
 
+  lanBegin(lanMode);
+
   delay(800);
-  updateData();
-  lastUpdate      = millis();
-  lastSlideChange = millis();
+
+  // Задачи. Данные — как только синхронизируются часы (иначе у точек время 0)
+  schedAdd("net",     taskNetwork);
+  taskIdClock   = schedAdd("clock",   taskClock);
+  taskIdData    = schedAdd("data",    taskData);
+  taskIdSlides  = schedAdd("slides",  taskSlides, slideInterval);
+  taskIdDisplay = schedAdd("display", taskDisplay);
+  schedAdd("lan",     taskLanHeartbeat, LAN_HEARTBEAT_INTERVAL);
 }
 
 // ================== LOOP ==================
 void loop() {
+  schedRun();
+}
+
+// ================== ЗАДАЧИ ==================
+uint32_t taskNetwork() {
   ArduinoOTA.handle();
   server.handleClient();
-  timeClient.update();
 
-  // Обновление данных каждые 5 минут
-  if (millis() - lastUpdate > 300000UL) {
-    updateData();
-    lastUpdate = millis();
+  LanSnapshot snap;
+  if (lanReceive(snap)) onLanSnapshot(snap, micros());
+  return netPollInterval;
+}
+
+uint32_t taskClock() {
+  timeTick();
+  if (!clockWasSynced && timeSynced()) {
+    clockWasSynced = true;
+    onFirstSync();
+  }
+  return timeMsToNextTick();
+}
+
+uint32_t taskData() {
+  // Первый запрос ждёт SNTP: точки со временем 0 ушли бы в выгрузку как 1970.
+  // Без синхронизации идём по таймауту, время проставит onFirstSync()
+  uint32_t waited = millis() - syncWaitStartMs;
+  if (!firstFetchDone && !timeSynced() && waited < firstFetchTimeout) {
+    return firstFetchTimeout - waited;
   }
+  firstFetchDone = true;
+  updateData();
+  return dataInterval;
+}
 
-  // Переключение слайдов
-  if (millis() - lastSlideChange > slideInterval) {
-    currentSlide = (currentSlide + 1) % totalSlides;
-    lastSlideChange = millis();
+uint32_t taskSlides() {
+  // После слайда оповещения ротация начинается сначала
+  currentSlide = currentSlide + 1 >= totalSlides ? 0 : currentSlide + 1;
+  requestRedraw();
+  return slideInterval;
+}
+
+uint32_t taskDisplay() {
+  if (displayDirty) {
+    displayDirty = false;
+    displayData();
   }
+  return SCHED_WAIT_TRIGGER;
+}
+
+uint32_t taskLanHeartbeat() {
+  // Повтор последнего снимка: ведомые ловят пропущенное. Устаревший снимок
+  // не повторяем — ведомые должны перейти на свои запросы, а не висеть на нём
+  if (lanMode == LAN_LEADER && lanFresh(lanState, millis())) lanSend(lanState.last);
+  return LAN_HEARTBEAT_INTERVAL;
+}
 
-  displayData();
+void requestRedraw() {
+  displayDirty = true;
+  schedTrigger(taskIdDisplay);
 }
 
 // ================== КРИПТА (Binance) ==================
-float getCryptoRate(const String& symbol) {
-  if (symbol.length() == 0) return 0.0f;
+// arrivedUs — micros() момента, когда цена разобрана (для задержки оповещений)
+float getCryptoRate(const char* symbol, uint32_t& arrivedUs) {
+  if (symbol[0] == 0) return 0.0f;
 
   WiFiClientSecure client;
   client.setInsecure();
   HTTPClient https;
+  // HTTP/1.0 — без chunked, чтобы JSON можно было разбирать прямо из потока
+  https.useHTTP10(true);
 
-  String url = "https://api.binance.com/api/v3/ticker/price?symbol=" + symbol;
+  char url[96];
+  snprintf(url, sizeof(url),
+           "https://api.binance.com/api/v3/ticker/price?symbol=%s", symbol);
 
   if (https.begin(client, url)) {
     int httpCode = https.GET();
     if (httpCode == HTTP_CODE_OK) {
-      String payload = https.getString();
       StaticJsonDocument<256> doc;
-      DeserializationError err = deserializeJson(doc, payload);
+      DeserializationError err = deserializeJson(doc, https.getStream());
+      arrivedUs = micros();
       https.end();
 
       if (!err) {
-        String priceStr = doc["price"].as<String>();
-        float price = priceStr.toFloat();
-        return price;
+        // Binance отдаёт цену строкой
+        const char* priceStr = doc["price"] | "0";
+        return strtof(priceStr, nullptr);
       } else {
         Serial.print("Binance JSON error: ");
         Serial.println(err.c_str());
@@ -227,8 +426,14 @@ float getCryptoRate(const String& symbol) {
 }
 
 // ================== ПОГОДА (OpenWeather) ==================
+void buildWeatherUrl() {
+  snprintf(weatherUrl, sizeof(weatherUrl),
+           "https://api.openweathermap.org/data/2.5/weather?q=%s&appid=%s&units=metric",
+           weatherCity, weatherApiKey);
+}
+
 void getWeather() {
-  if (weatherApiKey.length() == 0) {
+  if (weatherApiKey[0] == 0) {
     Serial.println("No OpenWeather API key set");
     return;
   }
@@ -236,18 +441,33 @@ void getWeather() {
   WiFiClientSecure client;
   client.setInsecure();
   HTTPClient https;
+  https.useHTTP10(true);
 
   if (https.begin(client, weatherUrl)) {
     Serial.println(weatherUrl);
     int httpCode = https.GET();
     if (httpCode == HTTP_CODE_OK) {
-      String payload = https.getString();
-      StaticJsonDocument<1024> doc;
-      DeserializationError err = deserializeJson(doc, payload);
+      // Из всего ответа нужны только температура и описание:
+      // { "main": { "temp" }, "weather": [ { "main" } ] }
+      StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(1) +
+                         JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(1)> filter;
+      filter["main"]["temp"] = true;
+      filter["weather"][0]["main"] = true;
+      if (filter.overflowed()) {
+        Serial.println("Weather JSON filter overflow");
+        https.end();
+        return;
+      }
+
+      StaticJsonDocument<256> doc;
+      DeserializationError err = deserializeJson(doc, https.getStream(),
+                                                 DeserializationOption::Filter(filter));
 
       if (!err) {
         temperature = doc["main"]["temp"].as<float>();
-        weatherDescription = doc["weather"][0]["main"].as<String>();
+        strlcpy(weatherDescription, doc["weather"][0]["main"] | "",
+                sizeof(weatherDescription));
+        haveWeather = true;
         Serial.print("Temp: ");
         Serial.println(temperature);
       } else {
@@ -264,22 +484,39 @@ void getWeather() {
   }
 }
 
-// ================== ЛОГИКА ОБНОВЛЕНИЯ ==================
-void updateHistory(float history[], float newValue) {
-  for (int i = 4; i > 0; i--) {
-    history[i] = history[i - 1];
-  }
-  history[0] = newValue;
+// Погода вне расписания (сменили город или ключ). Цены здесь не качаем:
+// лишний тик в истории ничего не даёт, расписание данных остаётся прежним
+void refreshWeather() {
+  if (leaderCoversWeather()) return;  // придёт со снимком лидера
+  getWeather();
+  requestRedraw();
 }
 
+// ================== ЛОГИКА ОБНОВЛЕНИЯ ==================
 bool updateData() {
-  float newCr1 = getCryptoRate(crypto1Symbol);
-  float newCr2 = getCryptoRate(crypto2Symbol);
+  // Ведомый при живом лидере в Binance не ходит
+  if (leaderCoversCrypto()) {
+    if (!leaderCoversWeather()) getWeather();
+    return true;
+  }
+
+  uint32_t arrived1Us = 0, arrived2Us = 0;
+  float newCr1 = getCryptoRate(crypto1Symbol, arrived1Us);
+  float newCr2 = getCryptoRate(crypto2Symbol, arrived2Us);
 
   if (newCr1 > 0 && newCr2 > 0) {
-    updateHistory(crypto1History, newCr1);
-    updateHistory(crypto2History, newCr2);
+    uint32_t now = timeNowUtc();
+    statsPush(crypto1Stats, newCr1, now);
+    statsPush(crypto2Stats, newCr2, now);
+    onPriceTick(0, arrived1Us);
+    onPriceTick(1, arrived2Us);
     getWeather();
+    requestRedraw();
+    lanPublish();
+
+    Serial.printf("Heap: free %u, max block %u, frag %u%%\n",
+                  ESP.getFreeHeap(), ESP.getMaxFreeBlockSize(),
+                  ESP.getHeapFragmentation());
     return true;
   }
 
@@ -287,167 +524,201 @@ bool updateData() {
   return false;
 }
 
-// ================== OLED ==================
-void calcMinMax(const float *data, int n, float &minVal, float &maxVal) {
-  if (n <= 0) {
-    minVal = 0;
-    maxVal = 1;
-    return;
-  }
-  minVal = data[0];
-  maxVal = data[0];
-  for (int i = 1; i < n; i++) {
-    if (data[i] < minVal) minVal = data[i];
-    if (data[i] > maxVal) maxVal = data[i];
-  }
-  if (minVal == maxVal) {
-    maxVal = minVal + 1.0f;  // чтобы не делить на 0
-  }
+// ================== ЛОКАЛКА ==================
+// Лидер: снимок после каждого успешного обновления
+void lanPublish() {
+  if (lanMode != LAN_LEADER) return;
+
+  LanSnapshot snap;
+  memset(&snap, 0, sizeof(snap));
+  snap.time   = statsTime(crypto1Stats, 0);
+  strlcpy(snap.symbol1, crypto1Symbol, sizeof(snap.symbol1));
+  snap.price1 = statsValue(crypto1Stats, 0);
+  strlcpy(snap.symbol2, crypto2Symbol, sizeof(snap.symbol2));
+  snap.price2 = statsValue(crypto2Stats, 0);
+  snap.weatherValid = haveWeather;
+  strlcpy(snap.city, weatherCity, sizeof(snap.city));
+  snap.temperature  = temperature;
+  strlcpy(snap.weather, weatherDescription, sizeof(snap.weather));
+
+  lanLeaderUpdate(lanState, snap, millis());
+  lanSend(lanState.last);
 }
 
-String getBaseAsset(const String& symbol) {
-  // Если заканчивается на "USDT" — отрезаем
-  if (symbol.endsWith("USDT")) {
-    return symbol.substring(0, symbol.length() - 4);
+// Ведомый: новый снимок кладём в историю так же, как собственный тик
+void onLanSnapshot(const LanSnapshot& snap, uint32_t arrivedUs) {
+  if (!lanFollowerAccept(lanState, snap, millis())) return;  // heartbeat
+
+  if (leaderCoversCrypto() && snap.price1 > 0 && snap.price2 > 0) {
+    statsPush(crypto1Stats, snap.price1, snap.time);
+    statsPush(crypto2Stats, snap.price2, snap.time);
+    onPriceTick(0, arrivedUs);
+    onPriceTick(1, arrivedUs);
+  }
+  if (leaderCoversWeather()) {
+    temperature = snap.temperature;
+    strlcpy(weatherDescription, snap.weather, sizeof(weatherDescription));
+    haveWeather = true;
   }
-  return symbol;
+  requestRedraw();
 }
 
-void displayData() {
-  oled.clear();
+// Жив = присылает новые снимки; повторы старого снимка не в счёт
+bool leaderAlive() {
+  return lanMode == LAN_FOLLOWER && lanFresh(lanState, millis());
+}
 
-  // Заголовок
-  oled.setScale(1);
-  oled.setCursor(0, 0);
-  oled.print(" Finance Monitor ");
-  oled.line(0, 10, 127, 10);
+// Лидер качает те же монеты, что показываем мы
+bool leaderCoversCrypto() {
+  return lanMode == LAN_FOLLOWER &&
+         lanCoversCrypto(lanState, millis(), crypto1Symbol, crypto2Symbol);
+}
 
-  switch (currentSlide) {
-    case 0: {
-      // ===== Слайд 0: Crypto1 =====
-      oled.setScale(1);
-      oled.setCursor(0, 2);
-      oled.print("   ");
-      oled.print(getBaseAsset(crypto1Symbol));
-      oled.print(" / USDT");
-
-      oled.setScale(2);
-      oled.setCursor(10, 4);
-      if (crypto1History[0] > 0) {
-        oled.print("$");
-        oled.print(crypto1History[0], 0);
-      } else {
-        oled.print("N/A");
-      }
-      break;
-    }
+bool leaderCoversWeather() {
+  return lanMode == LAN_FOLLOWER && lanCoversWeather(lanState, millis(), weatherCity);
+}
 
-    case 1: {
-      // ===== Слайд 1: Crypto2 =====
-      oled.setScale(1);
-      oled.setCursor(0, 2);
-      oled.print("   ");
-      oled.print(getBaseAsset(crypto2Symbol));
-      oled.print(" / USDT");
-
-      oled.setScale(2);
-      oled.setCursor(10, 4);
-      if (crypto2History[0] > 0) {
-        oled.print("$");
-        oled.print(crypto2History[0], 0);
-      } else {
-        oled.print("N/A");
-      }
-      break;
-    }
+// ================== ОПОВЕЩЕНИЯ ==================
+// Вызывается сразу после того, как тик попал в историю монеты.
+// arrivedUs — когда цена пришла (ответ Binance или пакет лидера): от него
+// и считается задержка до кадра на OLED
+void onPriceTick(int coin, uint32_t arrivedUs) {
+  const PriceStats& s = coin == 0 ? crypto1Stats : crypto2Stats;
 
-    case 2: {
-      // ===== Слайд 2: Время =====
-      oled.setScale(1);
-      oled.setCursor(0, 2);
-      oled.print("   Time (NTP)");
+  for (int i = 0; i < ALERT_MAX_RULES; i++) {
+    const AlertRule& rule = alertRules[i];
+    if (rule.type == ALERT_NONE || rule.coin != coin) continue;
 
-      oled.setScale(3);
-      oled.setCursor(10, 4);
-      String t = timeClient.getFormattedTime();
-      oled.print(t.substring(0, 5)); // HH:MM
-      break;
-    }
+    float metric;
+    if (!alertCheck(rule, s, metric)) continue;
 
-    case 3: {
-      // ===== Слайд 3: Погода =====
-      oled.setScale(1);
-      oled.setCursor(0, 2);
-      oled.print(weatherCity);
-
-      oled.setScale(3);
-      oled.setCursor(0, 4);
-      if (weatherApiKey.length() > 0) {
-        oled.print(temperature, 1);
-        oled.print("C");
-      } else {
-        oled.print("--.-C");
-      }
+    alertLastRule   = i;
+    alertLastPrice  = statsValue(s, 0);
+    alertLastMetric = metric;
+    alertArrivedUs  = arrivedUs;
 
-      oled.setScale(1);
-      oled.setCursor(80, 2);
-      oled.print(weatherDescription);
-      break;
-    }
+    // Сначала OLED — без ожидания планировщика, потом уже веб
+    currentSlide = ALERT_SLIDE;
+    schedTrigger(taskIdSlides, alertHoldInterval);
+    displayDirty = false;
+    displayData();
 
-    case 4: {
-      // ===== Слайд 4: График двух крипт =====
-      oled.setScale(1);
-      oled.setCursor(0, 1);
-      oled.print(getBaseAsset(crypto1Symbol));
-      oled.print(" & ");
-      oled.print(getBaseAsset(crypto2Symbol));
-      oled.print(" (5)");
+    alertPublish();
+  }
+}
 
-      int x0 = 5;
-      int y0 = 63;
-      oled.line(x0, 20, x0, y0);     // Y
-      oled.line(x0, y0, 127, y0);    // X
+// Рассылка последнего оповещения подписчикам /events
+void alertPublish() {
+  const AlertRule& rule = alertRules[alertLastRule];
+  char desc[24];
+  alertDescribe(rule, desc, sizeof(desc));
+
+  char msg[128];
+  int len = snprintf(msg, sizeof(msg),
+                     "event: alert\ndata: %s %s @ %.8g (%.4g), latency %lu us\n\n",
+                     rule.coin == 0 ? crypto1Base : crypto2Base, desc,
+                     alertLastPrice, alertLastMetric, (unsigned long)alertLatencyUs);
+
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (sseClients[i].connected()) {
+      sseClients[i].write((const uint8_t*)msg, len);
+    }
+  }
+}
 
-      float min1, max1, min2, max2;
-      calcMinMax(crypto1History, 5, min1, max1);
-      calcMinMax(crypto2History, 5, min2, max2);
+// ================== OLED ==================
+void getBaseAsset(const char* symbol, char* out, size_t outLen) {
+  size_t len = strlen(symbol);
+  // Если заканчивается на "USDT" — отрезаем
+  if (len > 4 && strcmp(symbol + len - 4, "USDT") == 0) {
+    len -= 4;
+  }
+  if (len >= outLen) len = outLen - 1;
+  memcpy(out, symbol, len);
+  out[len] = 0;
+}
 
-      float scale1 = 35.0f / (max1 - min1);
-      float scale2 = 35.0f / (max2 - min2);
+void updateBaseAssets() {
+  getBaseAsset(crypto1Symbol, crypto1Base, sizeof(crypto1Base));
+  getBaseAsset(crypto2Symbol, crypto2Base, sizeof(crypto2Base));
+}
 
-      // Линия Crypto1
-      for (int i = 0; i < 4; i++) {
-        int xp0 = x0 + 10 + i * 25;
-        int xp1 = x0 + 10 + (i + 1) * 25;
+void displayData() {
+  uint32_t startUs = micros();
+  int slide = currentSlide;
+
+  SlideData d;
+  d.stats[0]    = &crypto1Stats;
+  d.stats[1]    = &crypto2Stats;
+  d.bases[0]    = crypto1Base;
+  d.bases[1]    = crypto2Base;
+  d.clock       = clockText;
+  d.city        = weatherCity;
+  d.haveWeather = haveWeather;
+  d.temperature = temperature;
+  d.weather     = weatherDescription;
+  d.alert       = alertLastRule >= 0 ? &alertRules[alertLastRule] : nullptr;
+  d.alertPrice  = alertLastPrice;
+  drawSlide(oled, slide, d);
+
+  uint32_t drawnUs = micros();
+  oled.update();
+  uint32_t doneUs = micros();
+
+  SlideTiming& t = slideTiming[slide];
+  t.frames++;
+  t.drawUs   = drawnUs - startUs;
+  t.updateUs = doneUs - drawnUs;
+  if (doneUs - startUs > t.maxUs) t.maxUs = doneUs - startUs;
+  t.pixels   = countLitPixels();
+  oledBytesPushed += OLED_FRAME_BYTES;
+
+  if (slide == ALERT_SLIDE && alertArrivedUs != 0) {
+    alertLatencyUs = doneUs - alertArrivedUs;
+    if (alertLatencyUs > alertLatencyMaxUs) alertLatencyMaxUs = alertLatencyUs;
+    alertArrivedUs = 0;
+  }
+}
 
-        int yp0 = y0 - (int)((crypto1History[4 - i]     - min1) * scale1);
-        int yp1 = y0 - (int)((crypto1History[4 - (i+1)] - min1) * scale1);
+// Буфер GyverOLED 128x64: по 8 байт-страниц на столбец, бит — строка внутри страницы
+bool oledPixel(int x, int y) {
+  return oled._oled_buffer[(x << 3) + (y >> 3)] & (1 << (y & 7));
+}
 
-        oled.line(xp0, yp0, xp1, yp1);
-      }
+uint16_t countLitPixels() {
+  uint16_t n = 0;
+  for (uint32_t i = 0; i < OLED_FRAME_BYTES; i++) {
+    n += __builtin_popcount(oled._oled_buffer[i]);
+  }
+  return n;
+}
 
-      // Точки Crypto2
-      for (int i = 0; i < 5; i++) {
-        int xp = x0 + 10 + i * 25;
-        int yp = y0 - (int)((crypto2History[4 - i] - min2) * scale2);
-        oled.dot(xp,   yp,   1);
-        oled.dot(xp+1, yp,   1);
-        oled.dot(xp,   yp+1, 1);
-        oled.dot(xp+1, yp+1, 1);
-      }
+// ================== ВРЕМЯ ==================
+// SNTP или смена пояса сдвинули часы — задача часов спит до старого дедлайна
+// (до минуты), будим её сразу
+void onTimeAdjusted() {
+  schedTrigger(taskIdClock);
+}
 
-      break;
-    }
-  }
+// Часы впервые синхронизированы: будим отложенный первый запрос данных, а точкам,
+// полученным до синхронизации (по таймауту), проставляем текущее время
+void onFirstSync() {
+  uint32_t now = timeNowUtc();
+  statsFillTime(crypto1Stats, now);
+  statsFillTime(crypto2Stats, now);
+  if (!firstFetchDone) schedTrigger(taskIdData);
+}
 
-  oled.update();
+// Вызывается сервисом времени раз в минуту — только тогда меняется HH:MM
+void onMinuteChanged(const struct tm& local) {
+  snprintf(clockText, sizeof(clockText), "%02d:%02d", local.tm_hour, local.tm_min);
+  if (currentSlide == 2) requestRedraw();
 }
 
 // ================== EEPROM ==================
-void saveStringToEEPROM(int offset, int maxLen, const String& value) {
+void saveStringToEEPROM(int offset, int maxLen, const char* value) {
   int i = 0;
-  for (; i < maxLen - 1 && i < (int)value.length(); i++) {
+  for (; i < maxLen - 1 && value[i] != 0; i++) {
     EEPROM.write(offset + i, value[i]);
   }
   EEPROM.write(offset + i, 0);
@@ -457,14 +728,15 @@ void saveStringToEEPROM(int offset, int maxLen, const String& value) {
   }
 }
 
-String readStringFromEEPROM(int offset, int maxLen) {
-  String res = "";
-  for (int i = 0; i < maxLen; i++) {
+// out должен вмещать maxLen байт; пустая строка — значит в EEPROM ничего нет
+void readStringFromEEPROM(int offset, int maxLen, char* out) {
+  int i = 0;
+  for (; i < maxLen - 1; i++) {
     uint8_t c = EEPROM.read(offset + i);
     if (c == 0 || c == 0xFF) break;
-    res += char(c);
+    out[i] = char(c);
   }
-  return res;
+  out[i] = 0;
 }
 
 void saveSettings() {
@@ -472,34 +744,68 @@ void saveSettings() {
   saveStringToEEPROM(EEPROM_API_OFFSET,  EEPROM_API_LEN,  weatherApiKey);
   saveStringToEEPROM(EEPROM_CR1_OFFSET,  EEPROM_CR1_LEN,  crypto1Symbol);
   saveStringToEEPROM(EEPROM_CR2_OFFSET,  EEPROM_CR2_LEN,  crypto2Symbol);
+  saveStringToEEPROM(EEPROM_TZ_OFFSET,   EEPROM_TZ_LEN,   timeZone);
+  EEPROM.write(EEPROM_LAN_OFFSET, lanMode);
+  EEPROM.put(EEPROM_ALERTS_OFFSET, alertRules);
+  saveStringToEEPROM(EEPROM_OTA_PASS_OFFSET, EEPROM_OTA_PASS_LEN, otaPassword);
   EEPROM.commit();
 }
 
 void loadSettings() {
-  String c  = readStringFromEEPROM(EEPROM_CITY_OFFSET, EEPROM_CITY_LEN);
-  if (c.length() > 0) weatherCity = c;
+  char buf[EEPROM_API_LEN];  // самое длинное поле
+
+  readStringFromEEPROM(EEPROM_CITY_OFFSET, EEPROM_CITY_LEN, buf);
+  if (buf[0]) strlcpy(weatherCity, buf, sizeof(weatherCity));
+
+  readStringFromEEPROM(EEPROM_API_OFFSET, EEPROM_API_LEN, buf);
+  if (buf[0]) strlcpy(weatherApiKey, buf, sizeof(weatherApiKey));
+
+  readStringFromEEPROM(EEPROM_CR1_OFFSET, EEPROM_CR1_LEN, buf);
+  if (buf[0]) strlcpy(crypto1Symbol, buf, sizeof(crypto1Symbol));
 
-  String k  = readStringFromEEPROM(EEPROM_API_OFFSET, EEPROM_API_LEN);
-  if (k.length() > 0) weatherApiKey = k;
+  readStringFromEEPROM(EEPROM_CR2_OFFSET, EEPROM_CR2_LEN, buf);
+  if (buf[0]) strlcpy(crypto2Symbol, buf, sizeof(crypto2Symbol));
 
-  String s1 = readStringFromEEPROM(EEPROM_CR1_OFFSET, EEPROM_CR1_LEN);
-  if (s1.length() > 0) crypto1Symbol = s1;
+  readStringFromEEPROM(EEPROM_TZ_OFFSET, EEPROM_TZ_LEN, buf);
+  if (buf[0]) strlcpy(timeZone, buf, sizeof(timeZone));
 
-  String s2 = readStringFromEEPROM(EEPROM_CR2_OFFSET, EEPROM_CR2_LEN);
-  if (s2.length() > 0) crypto2Symbol = s2;
+  readStringFromEEPROM(EEPROM_OTA_PASS_OFFSET, EEPROM_OTA_PASS_LEN, otaPassword);
+
+  uint8_t mode = EEPROM.read(EEPROM_LAN_OFFSET);
+  if (mode <= LAN_FOLLOWER) lanMode = (LanMode)mode;  // 0xFF — чистая EEPROM
+
+  EEPROM.get(EEPROM_ALERTS_OFFSET, alertRules);
+  for (int i = 0; i < ALERT_MAX_RULES; i++) {
+    if (!alertValid(alertRules[i])) memset(&alertRules[i], 0, sizeof(AlertRule));
+  }
+
+  updateBaseAssets();
 }
 
 // ================== HTTP HANDLERS ==================
+// Копирует аргумент запроса в буфер без пробелов по краям
+void copyArgTrimmed(const char* name, char* out, size_t outLen) {
+  const String& arg = server.arg(name);
+  const char* start = arg.c_str();
+  const char* end   = start + arg.length();
+  while (start < end && isspace((unsigned char)*start))   start++;
+  while (end > start && isspace((unsigned char)end[-1])) end--;
+
+  size_t len = end - start;
+  if (len >= outLen) len = outLen - 1;
+  memcpy(out, start, len);
+  out[len] = 0;
+}
+
 void handleSettingsUpdate() {
   if (server.hasArg("city")) {
-    weatherCity = server.arg("city");
-    weatherCity.trim();
+    copyArgTrimmed("city", weatherCity, sizeof(weatherCity));
     saveSettings();
+    haveWeather = false;
 
-    weatherUrl = "https://api.openweathermap.org/data/2.5/weather?q=" +
-                 weatherCity + "&appid=" + weatherApiKey + "&units=metric";
+    buildWeatherUrl();
 
-    updateData();
+    refreshWeather();
   }
   server.sendHeader("Location", "/");
   server.send(303);
@@ -516,7 +822,7 @@ void handleThemeUpdate() {
 
 void handleContrastUpdate() {
   if (server.hasArg("contrast")) {
-    contrastValue = server.arg("contrast").toInt();
+    contrastValue = atoi(server.arg("contrast").c_str());
     if (contrastValue < 0)   contrastValue = 0;
     if (contrastValue > 255) contrastValue = 255;
     oled.setContrast(contrastValue);
@@ -527,46 +833,372 @@ void handleContrastUpdate() {
 
 void handleApiKeyUpdate() {
   if (server.hasArg("apikey")) {
-    weatherApiKey = server.arg("apikey");
-    weatherApiKey.trim();
+    copyArgTrimmed("apikey", weatherApiKey, sizeof(weatherApiKey));
     saveSettings();
 
-    weatherUrl = "https://api.openweathermap.org/data/2.5/weather?q=" +
-                 weatherCity + "&appid=" + weatherApiKey + "&units=metric";
+    buildWeatherUrl();
 
-    updateData();
+    refreshWeather();
   }
   server.sendHeader("Location", "/");
   server.send(303);
 }
 
 void handleCryptoUpdate() {
-  bool changed = false;
+  const char* args[2]    = { "crypto1",      "crypto2"      };
+  char*       symbols[2] = { crypto1Symbol,  crypto2Symbol  };
+  size_t      sizes[2]   = { sizeof(crypto1Symbol), sizeof(crypto2Symbol) };
+  PriceStats* stats[2]   = { &crypto1Stats,  &crypto2Stats  };
+  bool        changed[2] = { false, false };
+
+  for (int c = 0; c < 2; c++) {
+    if (!server.hasArg(args[c])) continue;
+    char symbol[EEPROM_CR1_LEN];
+    copyArgTrimmed(args[c], symbol, sizeof(symbol));
+    if (strcmp(symbol, symbols[c]) == 0) continue;
+
+    strlcpy(symbols[c], symbol, sizes[c]);
+    changed[c] = true;
+
+    // История и правила оповещений относятся к старой монете
+    statsReset(*stats[c]);
+    for (int i = 0; i < ALERT_MAX_RULES; i++) {
+      if (alertRules[i].coin != c) continue;
+      alertRules[i].type = ALERT_NONE;
+      if (alertLastRule == i) alertLastRule = -1;
+    }
+  }
 
-  if (server.hasArg("crypto1")) {
-    crypto1Symbol = server.arg("crypto1");
-    crypto1Symbol.trim();
-    changed = true;
+  if (changed[0] || changed[1]) {
+    updateBaseAssets();
+    saveSettings();
+    updateData();
+
+    // Сразу показываем сменившуюся валюту на OLED
+    currentSlide = changed[0] ? 0 : 1;
+    schedTrigger(taskIdSlides, slideInterval);
+    requestRedraw();
   }
-  if (server.hasArg("crypto2")) {
-    crypto2Symbol = server.arg("crypto2");
-    crypto2Symbol.trim();
-    changed = true;
+
+  server.sendHeader("Location", "/");
+  server.send(303);
+}
+
+void handleTimezoneUpdate() {
+  if (server.hasArg("tz")) {
+    copyArgTrimmed("tz", timeZone, sizeof(timeZone));
+    saveSettings();
+    timeSetZone(timeZone);
   }
+  server.sendHeader("Location", "/");
+  server.send(303);
+}
 
-  if (changed) {
-    // Сброс истории при смене монет
-    for (int i = 0; i < 5; i++) {
-      crypto1History[i] = 0;
-      crypto2History[i] = 0;
+// Загрузка CPU по задачам за последнее окно планировщика
+void handleTasks() {
+  pageBegin("text/plain");
+  pagePrintf("window %lu ms, idle %u.%u%%\n", (unsigned long)SCHED_STATS_PERIOD,
+             schedIdlePermille() / 10, schedIdlePermille() % 10);
+  pagePrint("task      cpu%   runs  max_us\n");
+  for (int i = 0; i < schedTaskCount(); i++) {
+    const SchedTask& t = schedTask(i);
+    pagePrintf("%-8s %3u.%u %6lu %7lu\n", t.name,
+               t.sharePermille / 10, t.sharePermille % 10,
+               (unsigned long)t.lastRuns, (unsigned long)t.lastMaxUs);
+  }
+
+  pagePrintf("\noled bytes pushed %lu\n", (unsigned long)oledBytesPushed);
+  pagePrint("slide  frames draw_us update_us  max_us pixels\n");
+  for (int i = 0; i <= ALERT_SLIDE; i++) {
+    const SlideTiming& st = slideTiming[i];
+    pagePrintf("%5d %7lu %7lu %9lu %7lu %6u\n", i,
+               (unsigned long)st.frames, (unsigned long)st.drawUs,
+               (unsigned long)st.updateUs, (unsigned long)st.maxUs, st.pixels);
+  }
+
+  pagePrintf("\nalert price->oled last %lu us, max %lu us\n",
+             (unsigned long)alertLatencyUs, (unsigned long)alertLatencyMaxUs);
+  pageEnd();
+}
+
+// Текущий кадр OLED в PBM (P4): снимок для эталонных картинок слайдов.
+// Горящий пиксель = 1 (чёрный в PBM)
+void handleFramePbm() {
+  pageBegin("image/x-portable-bitmap");
+  pagePrintf("P4\n%d %d\n", OLED_W, OLED_H);
+  for (int y = 0; y < OLED_H; y++) {
+    uint8_t row[OLED_W / 8] = { 0 };
+    for (int x = 0; x < OLED_W; x++) {
+      if (oledPixel(x, y)) row[x >> 3] |= 0x80 >> (x & 7);
     }
+    pageWrite(row, sizeof(row));
+  }
+  pageEnd();
+}
+
+// ================== OTA ПО HTTP ==================
+// POST /update (multipart, поле с файлом прошивки), необязательно ?md5=<hex>.
+// Образ пишется во flash кусками по мере приёма. Сжатый gzip-образ
+// (firmware.bin.gz) ядро принимает как есть, а распаковывает загрузчик
+// при установке — по сети и во flash идёт только сжатый размер.
+// MD5 считается по загруженному файлу (т. е. по .gz, если он сжат).
+void handleUpdateUpload() {
+  HTTPUpload& upload = server.upload();
+
+  // Ошибку Updater печатаем один раз — когда загрузка из "хорошей" стала плохой
+  bool wasOk = upload.status == UPLOAD_FILE_START || otaHttp.ok();
+
+  switch (upload.status) {
+    case UPLOAD_FILE_START: {
+      // Заголовки уже разобраны: без пароля во flash не пишем ни байта
+      otaHttpAuthorized = otaAuthenticated();
+      if (!otaHttpAuthorized) {
+        Serial.println("HTTP update: not authorized");
+        return;
+      }
+      Serial.printf("HTTP update: %s\n", upload.filename.c_str());
+      uint32_t maxSize = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
+      otaHttpPercent = -1;
+      otaHttp.start(maxSize, server.hasArg("md5") ? server.arg("md5").c_str() : nullptr);
+      showUpdateProgress("Updating...", 0);
+      break;
+    }
+
+    case UPLOAD_FILE_WRITE:
+      if (!otaHttpAuthorized) return;
+      otaHttp.write(upload.buf, upload.currentSize);
+      if (upload.contentLength > 0) {
+        showUpdateProgress("Updating...", upload.totalSize * 100 / upload.contentLength);
+      }
+      break;
+
+    case UPLOAD_FILE_END:
+      if (!otaHttpAuthorized) return;
+      otaHttp.finish();
+      showUpdateProgress(otaHttp.ok() ? "Update OK" : "Update failed", 100);
+      break;
+
+    case UPLOAD_FILE_ABORTED:
+      if (!otaHttpAuthorized) return;
+      otaHttp.abort();
+      showUpdateProgress("Update aborted", 0);
+      break;
+  }
+
+  if (wasOk && !otaHttp.ok() && Update.hasError()) Update.printError(Serial);
+}
+
+void handleUpdateDone() {
+  if (!otaHttpAuthorized) {
+    if (!otaPassword[0]) {
+      server.send(403, "text/plain", "Set an update password first\n");
+    } else {
+      server.requestAuthentication();
+    }
+    return;
+  }
+  otaHttpAuthorized = false;
+  if (!otaHttp.ok()) {
+    server.send(500, "text/plain", "Update failed\n");
+    requestRedraw();
+    return;
+  }
+  server.send(200, "text/plain", "Update OK, rebooting\n");
+  delay(200);
+  ESP.restart();
+}
+
+// Пароль задан и пришёл в Basic auth. Заголовок Authorization страница с чужого
+// сайта отправить не может (no-cors его не пропускает)
+bool otaAuthenticated() {
+  return otaPassword[0] && server.authenticate(OTA_USER, otaPassword);
+}
+
+// Первый пароль задаётся без входа, смена — только со старым паролем
+void handleOtaPasswordUpdate() {
+  if (otaPassword[0] && !otaAuthenticated()) {
+    server.requestAuthentication();
+    return;
+  }
+  char pass[EEPROM_OTA_PASS_LEN];
+  copyArgTrimmed("password", pass, sizeof(pass));
+  if (pass[0]) {
+    strlcpy(otaPassword, pass, sizeof(otaPassword));
     saveSettings();
-    updateData();
+    ArduinoOTA.setPassword(otaPassword);
+  }
+  server.sendHeader("Location", "/");
+  server.send(303);
+}
+
+// Прогресс на OLED; перерисовываем только при смене процента
+void showUpdateProgress(const char* status, int percent) {
+  if (percent > 100) percent = 100;
+  if (percent == otaHttpPercent && percent != 100) return;
+  otaHttpPercent = percent;
+
+  oled.clear();
+  oled.setScale(1);
+  oled.setCursor(0, 0);
+  oled.print(" Firmware update ");
+  oled.line(0, 10, 127, 10);
+
+  oled.setCursor(0, 3);
+  oled.print(status);
+  oled.setCursor(100, 3);
+  oled.print(percent);
+  oled.print("%");
+
+  oled.rect(0, 40, 127, 50, OLED_STROKE);
+  if (percent > 0) oled.rect(0, 40, percent * 127 / 100, 50, OLED_FILL);
+  oled.update();
+}
+
+// ================== ЭКСПОРТ ИСТОРИИ ==================
+// /history.csv и /history.bin отдают всю историю прямо из кольцевых буферов.
+//   since=<unix> — только точки новее этого времени (для инкрементального сбора)
+//   step=<n>     — каждая n-я точка; выбор привязан к номеру точки,
+//                  поэтому при повторных запросах прореживание не "плывёт"
+struct HistoryQuery {
+  uint32_t since;
+  uint32_t step;
+};
+
+HistoryQuery parseHistoryQuery() {
+  HistoryQuery q = { 0, 1 };
+  if (server.hasArg("since")) q.since = strtoul(server.arg("since").c_str(), nullptr, 10);
+  if (server.hasArg("step"))  q.step  = strtoul(server.arg("step").c_str(),  nullptr, 10);
+  if (q.step == 0) q.step = 1;
+  return q;
+}
+
+bool historySelected(const PriceStats& s, int age, const HistoryQuery& q) {
+  if (q.since != 0 && statsTime(s, age) <= q.since) return false;
+  uint32_t seq = s.seq - 1 - age;
+  return seq % q.step == 0;
+}
 
-    // Сразу показываем первую валюту на OLED
-    currentSlide = 0;
-    lastSlideChange = millis();
+void handleHistoryCsv() {
+  HistoryQuery q = parseHistoryQuery();
+  const PriceStats* stats[2]   = { &crypto1Stats,  &crypto2Stats  };
+  const char*       symbols[2] = { crypto1Symbol,  crypto2Symbol  };
+
+  pageBegin("text/csv");
+  pagePrint("symbol,time,price\n");
+  for (int c = 0; c < 2; c++) {
+    // От старых к новым
+    for (int age = stats[c]->size - 1; age >= 0; age--) {
+      if (!historySelected(*stats[c], age, q)) continue;
+      pagePrintf("%s,%lu,%.8g\n", symbols[c],
+                 (unsigned long)statsTime(*stats[c], age), statsValue(*stats[c], age));
+    }
   }
+  pageEnd();
+}
+
+// Формат (little-endian):
+//   "OCH1", uint8 число символов
+//   на символ: uint8 длина, символ, uint16 число точек,
+//              точки { uint32 unix-время, float цена } от старых к новым
+void handleHistoryBin() {
+  HistoryQuery q = parseHistoryQuery();
+  const PriceStats* stats[2]   = { &crypto1Stats,  &crypto2Stats  };
+  const char*       symbols[2] = { crypto1Symbol,  crypto2Symbol  };
+
+  pageBegin("application/octet-stream");
+  uint8_t symbolCount = 2;
+  pageWrite("OCH1", 4);
+  pageWrite(&symbolCount, 1);
+
+  for (int c = 0; c < 2; c++) {
+    const PriceStats& s = *stats[c];
+
+    uint8_t symLen = strlen(symbols[c]);
+    pageWrite(&symLen, 1);
+    pageWrite(symbols[c], symLen);
+
+    // Число точек нужно до самих точек — отдельный проход без аллокаций
+    uint16_t count = 0;
+    for (int age = s.size - 1; age >= 0; age--) {
+      if (historySelected(s, age, q)) count++;
+    }
+    pageWrite(&count, sizeof(count));
+
+    for (int age = s.size - 1; age >= 0; age--) {
+      if (!historySelected(s, age, q)) continue;
+      uint32_t t     = statsTime(s, age);
+      float    price = statsValue(s, age);
+      pageWrite(&t,     sizeof(t));
+      pageWrite(&price, sizeof(price));
+    }
+  }
+  pageEnd();
+}
+
+void handleLanModeUpdate() {
+  if (server.hasArg("mode")) {
+    int mode = atoi(server.arg("mode").c_str());
+    if (mode >= LAN_STANDALONE && mode <= LAN_FOLLOWER) {
+      lanMode = (LanMode)mode;
+      lanReset(lanState);
+      saveSettings();
+      lanBegin(lanMode);
+    }
+  }
+  server.sendHeader("Location", "/");
+  server.send(303);
+}
+
+// Подписка на оповещения (Server-Sent Events). Соединение остаётся открытым,
+// события пишутся в него напрямую из alertPublish()
+void handleEvents() {
+  for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (sseClients[i].connected()) continue;
+
+    sseClients[i] = server.client();
+    sseClients[i].setNoDelay(true);
+    sseClients[i].print("HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/event-stream\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Connection: keep-alive\r\n\r\n");
+    return;
+  }
+  server.send(503, "text/plain", "Too many event subscribers\n");
+}
+
+void handleAlertAdd() {
+  // Разбираем в long и проверяем диапазон до сужения: иначе type=257 стал бы
+  // ALERT_ABOVE, а coin=256 — монетой 0
+  long type  = strtol(server.arg("type").c_str(),  nullptr, 10);
+  long coin  = strtol(server.arg("coin").c_str(),  nullptr, 10);
+  long param = strtol(server.arg("param").c_str(), nullptr, 10);
+  bool inRange = type >= 0 && type <= 0xFF && coin >= 0 && coin <= 0xFF &&
+                 param >= 0 && param <= 0xFFFF;
+
+  if (!inRange) type = ALERT_NONE;   // alertValid() такое правило отклонит
+
+  AlertRule rule;
+  rule.type  = type;
+  rule.coin  = coin;
+  rule.param = param;
+  rule.level = strtof(server.arg("level").c_str(), nullptr);  // nan/inf отсечёт alertValid
+
+  if (alertValid(rule)) {
+    for (int i = 0; i < ALERT_MAX_RULES; i++) {
+      if (alertRules[i].type != ALERT_NONE) continue;
+      alertRules[i] = rule;
+      saveSettings();
+      break;
+    }
+  }
+  server.sendHeader("Location", "/");
+  server.send(303);
+}
+
+void handleAlertClear() {
+  memset(alertRules, 0, sizeof(alertRules));
+  alertLastRule = -1;
+  saveSettings();
 
   server.sendHeader("Location", "/");
   server.send(303);
@@ -574,210 +1206,334 @@ void handleCryptoUpdate() {
 
 // ================== ВЕБ-СТРАНИЦА ==================
 void handleRoot() {
-  String trend1 = "-";
-  String trend2 = "-";
+  const char* trend1 = "-";
+  const char* trend2 = "-";
 
-  if (crypto1History[0] > 0 && crypto1History[1] > 0) {
-    trend1 = (crypto1History[0] > crypto1History[1]) ? "📈" : "📉";
+  // Тренд — цена относительно короткой EMA
+  if (statsTrend(crypto1Stats) != 0) {
+    trend1 = statsTrend(crypto1Stats) > 0 ? "📈" : "📉";
   }
-  if (crypto2History[0] > 0 && crypto2History[1] > 0) {
-    trend2 = (crypto2History[0] > crypto2History[1]) ? "📈" : "📉";
+  if (statsTrend(crypto2Stats) != 0) {
+    trend2 = statsTrend(crypto2Stats) > 0 ? "📈" : "📉";
   }
 
+  char ch1h[10], ch24h[10];
+
   // Подготовим точки для SVG графика первой крипты
-  float min1, max1;
-  calcMinMax(crypto1History, 5, min1, max1);
-  float scale = 40.0f / (max1 - min1);
-
-  String points = "";
-  for (int i = 4; i >= 0; i--) {
-    int x = 10 + (4 - i) * 25;
-    int y = 60 - (int)((crypto1History[i] - min1) * scale);
-    points += String(x) + "," + String(y) + " ";
-  }
-
-  String html;
-  html.reserve(5000);
-
-  html += "<!DOCTYPE html><html><head>";
-  html += "<meta charset='UTF-8'>";
-  html += "<title>Finance Monitor</title>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-  html += "<style>";
-  html += "body{margin:0;padding:0;font-family:-apple-system,BlinkMacSystemFont,Segoe UI,sans-serif;background:radial-gradient(circle at top,#2b5876,#0b0f1a);color:#ffffff;display:flex;justify-content:center;align-items:center;min-height:100vh;}";
-  html += ".wrapper{max-width:420px;width:90%;padding:20px;}";
-  html += ".card{background:rgba(12,12,20,0.9);border-radius:16px;padding:20px;box-shadow:0 15px 40px rgba(0,0,0,0.45);backdrop-filter:blur(10px);}";
-  html += "h1{margin:0 0 10px;font-size:24px;}";
-  html += ".subtitle{font-size:12px;opacity:0.7;margin-bottom:20px;}";
-  html += ".grid{display:grid;grid-template-columns:1fr 1fr;gap:12px;margin-bottom:20px;}";
-  html += ".tile{background:#181820;border-radius:12px;padding:12px;text-align:left;}";
-  html += ".label{font-size:12px;opacity:0.7;}";
-  html += ".value{font-size:18px;margin-top:4px;}";
-  html += ".emoji{font-size:18px;margin-right:4px;}";
-  html += ".weather{margin-top:8px;font-size:12px;opacity:0.8;}";
-  html += "svg{width:100%;height:90px;margin:10px 0 4px;}";
-  html += ".buttons{display:flex;flex-direction:column;gap:8px;margin-top:10px;}";
-  html += "input,button,select{border-radius:999px;border:none;padding:8px 14px;font-size:12px;outline:none;}";
-  html += "input,select{background:#101018;color:white;}";
-  html += "button{background:#4caf50;color:white;cursor:pointer;transition:transform .1s,box-shadow .1s,background .1s;}";
-  html += "button:hover{transform:translateY(-1px);box-shadow:0 4px 12px rgba(0,0,0,0.4);background:#5ecf62;}";
-  html += "button.secondary{background:#30303c;}";
-  html += ".footer{margin-top:12px;font-size:11px;opacity:0.6;}";
-  html += ".form-row{display:flex;flex-direction:column;gap:4px;margin-top:6px;}";
-  html += ".form-row small{font-size:10px;opacity:0.6;}";
-  html += "</style></head><body>";
-
-  html += "<div class='wrapper'><div class='card'>";
-  html += "<h1>Finance Monitor</h1>";
-  html += "<div class='subtitle'>ESP8266 • OLED • Binance + Weather</div>";
+  char points[64] = "";
+  size_t pointsLen = 0;
+  for (int age = CHART_POINTS - 1; age >= 0; age--) {
+    if (age >= crypto1Stats.size) continue;
+    int x = 10 + (CHART_POINTS - 1 - age) * 25;
+    int y = chartY(crypto1Stats, age, 60, 40.0f);
+    pointsLen += snprintf(points + pointsLen, sizeof(points) - pointsLen,
+                          "%d,%d ", x, y);
+  }
+
+  pageBegin("text/html");
+  pagePrint("<!DOCTYPE html><html><head>");
+  pagePrint("<meta charset='UTF-8'>");
+  pagePrint("<title>Finance Monitor</title>");
+  pagePrint("<meta name='viewport' content='width=device-width, initial-scale=1'>");
+  pagePrint("<style>");
+  pagePrint("body{margin:0;padding:0;font-family:-apple-system,BlinkMacSystemFont,Segoe UI,sans-serif;background:radial-gradient(circle at top,#2b5876,#0b0f1a);color:#ffffff;display:flex;justify-content:center;align-items:center;min-height:100vh;}");
+  pagePrint(".wrapper{max-width:420px;width:90%;padding:20px;}");
+  pagePrint(".card{background:rgba(12,12,20,0.9);border-radius:16px;padding:20px;box-shadow:0 15px 40px rgba(0,0,0,0.45);backdrop-filter:blur(10px);}");
+  pagePrint("h1{margin:0 0 10px;font-size:24px;}");
+  pagePrint(".subtitle{font-size:12px;opacity:0.7;margin-bottom:20px;}");
+  pagePrint(".grid{display:grid;grid-template-columns:1fr 1fr;gap:12px;margin-bottom:20px;}");
+  pagePrint(".tile{background:#181820;border-radius:12px;padding:12px;text-align:left;}");
+  pagePrint(".label{font-size:12px;opacity:0.7;}");
+  pagePrint(".value{font-size:18px;margin-top:4px;}");
+  pagePrint(".emoji{font-size:18px;margin-right:4px;}");
+  pagePrint(".weather{margin-top:8px;font-size:12px;opacity:0.8;}");
+  pagePrint("svg{width:100%;height:90px;margin:10px 0 4px;}");
+  pagePrint(".buttons{display:flex;flex-direction:column;gap:8px;margin-top:10px;}");
+  pagePrint("input,button,select{border-radius:999px;border:none;padding:8px 14px;font-size:12px;outline:none;}");
+  pagePrint("input,select{background:#101018;color:white;}");
+  pagePrint("button{background:#4caf50;color:white;cursor:pointer;transition:transform .1s,box-shadow .1s,background .1s;}");
+  pagePrint("button:hover{transform:translateY(-1px);box-shadow:0 4px 12px rgba(0,0,0,0.4);background:#5ecf62;}");
+  pagePrint("button.secondary{background:#30303c;}");
+  pagePrint(".footer{margin-top:12px;font-size:11px;opacity:0.6;}");
+  pagePrint(".form-row{display:flex;flex-direction:column;gap:4px;margin-top:6px;}");
+  pagePrint(".form-row small{font-size:10px;opacity:0.6;}");
+  pagePrint("</style></head><body>");
+
+  pagePrint("<div class='wrapper'><div class='card'>");
+  pagePrint("<h1>Finance Monitor</h1>");
+  pagePrint("<div class='subtitle'>ESP8266 • OLED • Binance + Weather</div>");
 
   // ===== Две крипты =====
-  html += "<div class='grid'>";
+  pagePrint("<div id='alert' class='tile' style='display:none;margin-bottom:12px;background:#8a1c1c;'></div>");
+
+  pagePrint("<div class='grid'>");
 
   // Crypto1 tile
-  html += "<div class='tile'>";
-  html += "<div class='label'><span class='emoji'>₿</span>";
-  html += getBaseAsset(crypto1Symbol);
-  html += " / USDT</div>";
-  html += "<div class='value'>$";
-  html += String(crypto1History[0], 2);
-  html += " ";
-  html += trend1;
-  html += "</div>";
-  html += "<div class='weather' style='font-size:11px;opacity:0.6;'>symbol: ";
-  html += crypto1Symbol;
-  html += "</div>";
-  html += "</div>";
+  pagePrint("<div class='tile'>");
+  pagePrint("<div class='label'><span class='emoji'>₿</span>");
+  pagePrint(crypto1Base);
+  pagePrint(" / USDT</div>");
+  pagePrintf("<div class='value'>$%.2f %s</div>", statsValue(crypto1Stats, 0), trend1);
+  formatChange(ch1h,  sizeof(ch1h),  crypto1Stats.change1h);
+  formatChange(ch24h, sizeof(ch24h), crypto1Stats.change24h);
+  pagePrintf("<div class='weather'>1h %s • 24h %s</div>", ch1h, ch24h);
+  pagePrint("<div class='weather' style='font-size:11px;opacity:0.6;'>symbol: ");
+  pagePrint(crypto1Symbol);
+  pagePrint("</div>");
+  pagePrint("</div>");
 
   // Crypto2 tile
-  html += "<div class='tile'>";
-  html += "<div class='label'><span class='emoji'>Ξ</span>";
-  html += getBaseAsset(crypto2Symbol);
-  html += " / USDT</div>";
-  html += "<div class='value'>$";
-  html += String(crypto2History[0], 2);
-  html += " ";
-  html += trend2;
-  html += "</div>";
-  html += "<div class='weather' style='font-size:11px;opacity:0.6;'>symbol: ";
-  html += crypto2Symbol;
-  html += "</div>";
-  html += "</div>";
-
-  html += "</div>"; // .grid
+  pagePrint("<div class='tile'>");
+  pagePrint("<div class='label'><span class='emoji'>Ξ</span>");
+  pagePrint(crypto2Base);
+  pagePrint(" / USDT</div>");
+  pagePrintf("<div class='value'>$%.2f %s</div>", statsValue(crypto2Stats, 0), trend2);
+  formatChange(ch1h,  sizeof(ch1h),  crypto2Stats.change1h);
+  formatChange(ch24h, sizeof(ch24h), crypto2Stats.change24h);
+  pagePrintf("<div class='weather'>1h %s • 24h %s</div>", ch1h, ch24h);
+  pagePrint("<div class='weather' style='font-size:11px;opacity:0.6;'>symbol: ");
+  pagePrint(crypto2Symbol);
+  pagePrint("</div>");
+  pagePrint("</div>");
+
+  pagePrint("</div>"); // .grid
 
   // ===== График первой крипты =====
-  html += "<div class='tile'>";
-  html += "<div class='label'>";
-  html += getBaseAsset(crypto1Symbol);
-  html += " history (5 points)</div>";
-  html += "<svg viewBox='0 0 120 70'>";
-  html += "<polyline fill='none' stroke='#4caf50' stroke-width='2' points='";
-  html += points;
-  html += "' /></svg>";
-  html += "<div class='label'>Relative last 5 updates</div>";
-  html += "</div>";
+  pagePrint("<div class='tile'>");
+  pagePrint("<div class='label'>");
+  pagePrint(crypto1Base);
+  pagePrint(" history (5 points)</div>");
+  pagePrint("<svg viewBox='0 0 120 70'>");
+  pagePrint("<polyline fill='none' stroke='#4caf50' stroke-width='2' points='");
+  pagePrint(points);
+  pagePrint("' /></svg>");
+  pagePrint("<div class='label'>Relative last 5 updates</div>");
+  pagePrint("</div>");
 
   // ===== Погода =====
-  html += "<div class='tile' style='margin-top:12px;'>";
-  html += "<div class='label'><span class='emoji'>☁</span>Weather</div>";
-  html += "<div class='value'>";
-  html += weatherCity;
-  html += " — ";
-  html += String(temperature, 1);
-  html += "°C</div>";
-  html += "<div class='weather'>";
-  html += weatherDescription;
-  html += "</div>";
-  html += "</div>";
+  pagePrint("<div class='tile' style='margin-top:12px;'>");
+  pagePrint("<div class='label'><span class='emoji'>☁</span>Weather</div>");
+  pagePrint("<div class='value'>");
+  pagePrint(weatherCity);
+  pagePrintf(" — %.1f°C</div>", temperature);
+  pagePrint("<div class='weather'>");
+  pagePrint(weatherDescription);
+  pagePrint("</div>");
+  pagePrint("</div>");
 
   // ===== ФОРМЫ / КНОПКИ =====
-  html += "<div class='buttons'>";
+  pagePrint("<div class='buttons'>");
 
   // Refresh
-  html += "<form method='POST' action='/refresh'>";
-  html += "<button type='submit'>🔄 Refresh now</button>";
-  html += "</form>";
+  pagePrint("<form method='POST' action='/refresh'>");
+  pagePrint("<button type='submit'>🔄 Refresh now</button>");
+  pagePrint("</form>");
 
   // Invert
-  html += "<form method='POST' action='/invert'>";
-  html += "<button type='submit' class='secondary'>Invert OLED</button>";
-  html += "</form>";
+  pagePrint("<form method='POST' action='/invert'>");
+  pagePrint("<button type='submit' class='secondary'>Invert OLED</button>");
+  pagePrint("</form>");
 
   // Contrast
-  html += "<form method='POST' action='/contrast'>";
-  html += "<div class='form-row'>";
-  html += "<input name='contrast' placeholder='Contrast (0-255)'>";
-  html += "<button type='submit' class='secondary'>Save contrast</button>";
-  html += "</div>";
-  html += "</form>";
+  pagePrint("<form method='POST' action='/contrast'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input name='contrast' placeholder='Contrast (0-255)'>");
+  pagePrint("<button type='submit' class='secondary'>Save contrast</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
 
   // City
-  html += "<form method='POST' action='/settings'>";
-  html += "<div class='form-row'>";
-  html += "<input name='city' placeholder='City' value='";
-  html += weatherCity;
-  html += "'>";
-  html += "<button type='submit' class='secondary'>Save city</button>";
-  html += "</div>";
-  html += "</form>";
+  pagePrint("<form method='POST' action='/settings'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input name='city' placeholder='City' value='");
+  pagePrint(weatherCity);
+  pagePrint("'>");
+  pagePrint("<button type='submit' class='secondary'>Save city</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
 
   // API key
-  html += "<form method='POST' action='/apikey'>";
-  html += "<div class='form-row'>";
-  html += "<input name='apikey' placeholder='OpenWeather API key' value='";
-  html += weatherApiKey;
-  html += "'>";
-  html += "<small>Key stored in EEPROM (for weather)</small>";
-  html += "<button type='submit' class='secondary'>Save API key</button>";
-  html += "</div>";
-  html += "</form>";
+  pagePrint("<form method='POST' action='/apikey'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input name='apikey' placeholder='OpenWeather API key' value='");
+  pagePrint(weatherApiKey);
+  pagePrint("'>");
+  pagePrint("<small>Key stored in EEPROM (for weather)</small>");
+  pagePrint("<button type='submit' class='secondary'>Save API key</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
+
+  // Timezone
+  pagePrint("<form method='POST' action='/timezone'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input name='tz' placeholder='Timezone (POSIX TZ)' value='");
+  pagePrint(timeZone);
+  pagePrint("'>");
+  pagePrint("<small>POSIX TZ, e.g. &lt;+03&gt;-3 or CET-1CEST,M3.5.0,M10.5.0/3</small>");
+  pagePrint("<button type='submit' class='secondary'>Save timezone</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
+
+  // Firmware (.bin или .bin.gz)
+  pagePrint("<form method='POST' action='/update' enctype='multipart/form-data'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input type='file' name='firmware' accept='.bin,.gz'>");
+  pagePrint("<small>Firmware .bin or gzip-compressed .bin.gz (login admin / update password)</small>");
+  pagePrint("<button type='submit' class='secondary'>Upload firmware</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
+
+  // Пароль прошивки
+  pagePrint("<form method='POST' action='/otapass'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<input type='password' name='password' placeholder='Update password'>");
+  pagePrint(otaPassword[0] ? "<small>Changing it asks for the current password</small>"
+                           : "<small>Not set: firmware upload is disabled</small>");
+  pagePrint("<button type='submit' class='secondary'>Save update password</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
+
+  // Alerts
+  pagePrint("<div class='tile'>");
+  pagePrint("<div class='label'><span class='emoji'>🔔</span>Alerts</div>");
+  for (int i = 0; i < ALERT_MAX_RULES; i++) {
+    const AlertRule& rule = alertRules[i];
+    if (rule.type == ALERT_NONE) continue;
+    char desc[24];
+    alertDescribe(rule, desc, sizeof(desc));
+    pagePrintf("<div class='weather'>%s %s</div>",
+               rule.coin == 0 ? crypto1Base : crypto2Base, desc);
+  }
+  pagePrintf("<div class='weather' style='font-size:11px;opacity:0.6;'>price → OLED: last %lu µs, max %lu µs</div>",
+             (unsigned long)alertLatencyUs, (unsigned long)alertLatencyMaxUs);
+  pagePrint("</div>");
+
+  pagePrint("<form method='POST' action='/alerts'>");
+  pagePrint("<div class='form-row'>");
+  pagePrintf("<select name='coin'><option value='0'>%s</option><option value='1'>%s</option></select>",
+             crypto1Base, crypto2Base);
+  pagePrint("<select name='type'>");
+  pagePrint("<option value='1'>Price above level</option>");
+  pagePrint("<option value='2'>Price below level</option>");
+  pagePrint("<option value='3'>Change ≥ level % over N minutes</option>");
+  pagePrint("<option value='4'>Price crosses EMA #N (0: 30m, 1: 1h, 2: 4h)</option>");
+  pagePrint("</select>");
+  pagePrint("<input name='level' placeholder='Level (price or %)'>");
+  pagePrint("<input name='param' placeholder='N (minutes / EMA #)'>");
+  pagePrint("<button type='submit' class='secondary'>Add alert</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
+
+  pagePrint("<form method='POST' action='/alerts/clear'>");
+  pagePrint("<button type='submit' class='secondary'>Clear alerts</button>");
+  pagePrint("</form>");
+
+  // LAN mode
+  const char* lanLabels[3] = { "Standalone", "Leader (fetch & share)", "Follower (use leader)" };
+  pagePrint("<form method='POST' action='/lan'>");
+  pagePrint("<div class='form-row'>");
+  if (lanMode == LAN_FOLLOWER) {
+    if (leaderAlive()) {
+      pagePrintf("<small>New data from leader %lu s ago</small>",
+                 (unsigned long)((millis() - lanState.freshMs) / 1000));
+    } else {
+      pagePrint("<small>No leader — fetching directly</small>");
+    }
+  }
+  pagePrint("<select name='mode'>");
+  for (int i = LAN_STANDALONE; i <= LAN_FOLLOWER; i++) {
+    pagePrintf("<option value='%d'%s>%s</option>", i,
+               lanMode == i ? " selected" : "", lanLabels[i]);
+  }
+  pagePrint("</select>");
+  pagePrint("<button type='submit' class='secondary'>Save LAN mode</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
 
   // Crypto selection (dropdown)
-  html += "<form method='POST' action='/crypto'>";
-  html += "<div class='form-row'>";
-  html += "<small>Crypto 1 (left tile / first slide)</small>";
-  html += "<select name='crypto1'>";
+  pagePrint("<form method='POST' action='/crypto'>");
+  pagePrint("<div class='form-row'>");
+  pagePrint("<small>Crypto 1 (left tile / first slide)</small>");
+  pagePrint("<select name='crypto1'>");
   for (int i = 0; i < coinOptionsCount; i++) {
-    html += "<option value='";
-    html += coinOptions[i].symbol;
-    html += "'";
-    if (crypto1Symbol == coinOptions[i].symbol) html += " selected";
-    html += ">";
-    html += coinOptions[i].label;
-    html += " (";
-    html += coinOptions[i].symbol;
-    html += ")</option>";
-  }
-  html += "</select>";
-
-  html += "<small>Crypto 2 (right tile / second slide)</small>";
-  html += "<select name='crypto2'>";
+    bool selected = strcmp(crypto1Symbol, coinOptions[i].symbol) == 0;
+    pagePrintf("<option value='%s'%s>%s (%s)</option>",
+               coinOptions[i].symbol, selected ? " selected" : "",
+               coinOptions[i].label, coinOptions[i].symbol);
+  }
+  pagePrint("</select>");
+
+  pagePrint("<small>Crypto 2 (right tile / second slide)</small>");
+  pagePrint("<select name='crypto2'>");
   for (int i = 0; i < coinOptionsCount; i++) {
-    html += "<option value='";
-    html += coinOptions[i].symbol;
-    html += "'";
-    if (crypto2Symbol == coinOptions[i].symbol) html += " selected";
-    html += ">";
-    html += coinOptions[i].label;
-    html += " (";
-    html += coinOptions[i].symbol;
-    html += ")</option>";
+    bool selected = strcmp(crypto2Symbol, coinOptions[i].symbol) == 0;
+    pagePrintf("<option value='%s'%s>%s (%s)</option>",
+               coinOptions[i].symbol, selected ? " selected" : "",
+               coinOptions[i].label, coinOptions[i].symbol);
   }
-  html += "</select>";
+  pagePrint("</select>");
 
-  html += "<button type='submit' class='secondary'>Save cryptos & update</button>";
-  html += "</div>";
-  html += "</form>";
+  pagePrint("<button type='submit' class='secondary'>Save cryptos & update</button>");
+  pagePrint("</div>");
+  pagePrint("</form>");
 
-  html += "</div>"; // .buttons
+  pagePrint("</div>"); // .buttons
 
-  html += "<div class='footer'>Auto refresh every 30 sec • Binance public API • ESP8266</div>";
+  pagePrint("<div class='footer'>Auto refresh every 30 sec • Binance public API • ESP8266</div>");
 
-  html += "</div></div>"; // .card .wrapper
+  pagePrint("</div></div>"); // .card .wrapper
 
-  html += "<script>setInterval(function(){location.reload();},30000);</script>";
-  html += "</body></html>";
+  pagePrint("<script>setInterval(function(){location.reload();},30000);");
+  pagePrint("var es=new EventSource('/events');");
+  pagePrint("es.addEventListener('alert',function(e){var a=document.getElementById('alert');a.textContent='🔔 '+e.data;a.style.display='block';});");
+  pagePrint("</script>");
+  pagePrint("</body></html>");
+
+  pageEnd();
+}
+
+// ================== ОТДАЧА СТРАНИЦ КУСКАМИ ==================
+// Страница уходит chunked-ответом через httpChunk, в куче ничего не собирается
+void pageFlush() {
+  if (httpChunkLen > 0) {
+    server.sendContent(httpChunk, httpChunkLen);
+    httpChunkLen = 0;
+  }
+}
+
+void pageBegin(const char* contentType) {
+  httpChunkLen = 0;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, contentType, "");
+}
+
+void pageWrite(const void* data, size_t len) {
+  const char* p = (const char*)data;
+  while (len > 0) {
+    size_t n = HTTP_CHUNK_SIZE - httpChunkLen;
+    if (n > len) n = len;
+    memcpy(httpChunk + httpChunkLen, p, n);
+    httpChunkLen += n;
+    p   += n;
+    len -= n;
+    if (httpChunkLen == HTTP_CHUNK_SIZE) pageFlush();
+  }
+}
+
+void pagePrint(const char* text) {
+  pageWrite(text, strlen(text));
+}
+
+void pagePrintf(const char* fmt, ...) {
+  char line[160];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  pagePrint(line);
+}
 
-  server.send(200, "text/html", html);
+void pageEnd() {
+  pageFlush();
+  server.sendContent("");  // завершающий пустой chunk
 }
@@ -0,0 +1,217 @@
+#include "priceStats.h"
+
+// ===== Кольцевой буфер =====
+static int ringIndex(const PriceStats& s, int age) {
+  int i = (int)s.head - 1 - age;
+  if (i < 0) i += HISTORY_LEN;
+  return i;
+}
+
+float statsValue(const PriceStats& s, int age) {
+  if (age < 0 || age >= s.size) return 0.0f;
+  return s.values[ringIndex(s, age)];
+}
+
+uint32_t statsTime(const PriceStats& s, int age) {
+  if (age < 0 || age >= s.size) return 0;
+  return s.times[ringIndex(s, age)];
+}
+
+// Значение и время точки по её номеру (номер должен быть в пределах истории)
+static float valueAt(const PriceStats& s, uint32_t seq) {
+  return statsValue(s, (int)(s.seq - 1 - seq));
+}
+
+static uint32_t timeAt(const PriceStats& s, uint32_t seq) {
+  return statsTime(s, (int)(s.seq - 1 - seq));
+}
+
+// Самая новая точка не позже time, начиная с возраста fromAge; -1 — нет такой.
+// Время с возрастом не растёт, так что хватает двоичного поиска
+static int ageAtOrBefore(const PriceStats& s, uint32_t time, int fromAge) {
+  int lo = fromAge;
+  int hi = s.size - 1;
+  if (lo > hi || statsTime(s, hi) > time) return -1;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (statsTime(s, mid) <= time) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
+}
+
+// ===== Волатильность =====
+// Доходность (%) точки seq от предыдущей, приведённая к TICK_SECONDS: z = r * sqrt(T / dt),
+// и её вес dt. Вес по времени: внеочередной тик через пару секунд почти не влияет
+// на оценку, а при ровном шаге все веса равны и это обычная дисперсия.
+static bool tickReturn(const PriceStats& s, uint32_t seq, double& z, double& w) {
+  if (seq == 0) return false;
+  int age = (int)(s.seq - 1 - seq);
+  if (age + 1 >= s.size) return false;
+
+  float    prev = statsValue(s, age + 1);
+  uint32_t dt   = statsTime(s, age) - statsTime(s, age + 1);
+  if (prev <= 0 || dt == 0) return false;
+
+  double r = (statsValue(s, age) - prev) / prev * 100.0;
+  z = r * sqrt((double)TICK_SECONDS / dt);
+  w = dt;
+  return true;
+}
+
+static void volApply(PriceStats& s, uint32_t seq, int sign) {
+  double z, w;
+  if (!tickReturn(s, seq, z, w)) return;
+  s.retWeight += sign * w;
+  s.retSum    += sign * w * z;
+  s.retSumSq  += sign * w * z * z;
+  s.retCount  += sign;
+}
+
+// Пересчёт сумм с нуля по окну. Нужен, если начало окна вытеснено из кольца
+// (сотни внеочередных тиков за час) — иначе его не вычесть, и после
+// statsFillTime(), когда у старых доходностей поменялся dt
+static void volRebuild(PriceStats& s, uint32_t from) {
+  s.retWeight = s.retSum = s.retSumSq = 0;
+  s.retCount  = 0;
+
+  uint32_t newest = s.seq - 1;
+  s.volTail = newest + 1;
+  for (int age = 0; age + 1 < s.size && statsTime(s, age) > from; age++) {
+    s.volTail = newest - age;
+  }
+  for (uint32_t seq = s.volTail; seq <= newest; seq++) volApply(s, seq, +1);
+}
+
+// Волатильность по текущим суммам
+static void volFinish(PriceStats& s) {
+  if (s.retCount == 0) {
+    s.retWeight = s.retSum = s.retSumSq = 0;  // без накопленной ошибки округления
+  }
+
+  if (s.retCount >= 2 && s.retWeight > 0) {
+    double mean = s.retSum / s.retWeight;
+    double var  = s.retSumSq / s.retWeight - mean * mean;
+    s.volatility = var > 0 ? sqrt(var) : 0.0f;
+  } else {
+    s.volatility = 0.0f;
+  }
+}
+
+static void volPush(PriceStats& s, uint32_t seq, uint32_t time) {
+  uint32_t from = time > VOL_WINDOW ? time - VOL_WINDOW : 0;
+
+  if (s.volTail <= seq && seq - s.volTail + 1 >= s.size) {
+    volRebuild(s, from);
+  } else {
+    volApply(s, seq, +1);
+    // Выкидываем доходности, вышедшие из окна по времени
+    while (s.volTail <= seq && timeAt(s, s.volTail) <= from) {
+      volApply(s, s.volTail, -1);
+      s.volTail++;
+    }
+  }
+
+  volFinish(s);
+}
+
+// ===== Монотонные очереди min/max =====
+static void queuePush(const PriceStats& s, uint32_t* q, uint8_t& head, uint8_t& len,
+                      uint32_t seq, float value, bool isMin) {
+  // Выкидываем точки, вышедшие из окна
+  while (len > 0 && q[head] + CHART_POINTS <= seq) {
+    head = (head + 1) % CHART_POINTS;
+    len--;
+  }
+  // Хвост, который уже никогда не станет экстремумом
+  while (len > 0) {
+    float back = valueAt(s, q[(head + len - 1) % CHART_POINTS]);
+    if (isMin ? back < value : back > value) break;
+    len--;
+  }
+  q[(head + len) % CHART_POINTS] = seq;
+  len++;
+}
+
+// ================== API ==================
+void statsReset(PriceStats& s) {
+  memset(&s, 0, sizeof(s));
+  s.volTail   = 1;   // у точки 0 доходности нет
+  s.change1h  = NAN;
+  s.change24h = NAN;
+}
+
+float statsChange(const PriceStats& s, uint32_t seconds, int age) {
+  if (age < 0 || age >= s.size) return NAN;
+  uint32_t t = statsTime(s, age);
+  if (t < seconds) return NAN;
+
+  uint32_t target = t - seconds;
+  int base = ageAtOrBefore(s, target + STATS_TIME_SLACK, age + 1);
+  if (base < 0) return NAN;
+  if (statsTime(s, base) + seconds / 4 < target) return NAN;  // дыра в истории
+
+  float old = statsValue(s, base);
+  if (old <= 0) return NAN;
+  return (statsValue(s, age) - old) / old * 100.0f;
+}
+
+void statsPush(PriceStats& s, float value, uint32_t time) {
+  // Время точек не убывает (подводка часов назад) — на этом держится поиск по времени
+  if (s.size > 0 && time < statsTime(s, 0)) time = statsTime(s, 0);
+  uint32_t dt  = s.size > 0 ? time - statsTime(s, 0) : 0;
+  uint32_t seq = s.seq;
+
+  s.values[s.head] = value;
+  s.times[s.head]  = time;
+  s.head = (s.head + 1) % HISTORY_LEN;
+  if (s.size < HISTORY_LEN) s.size++;
+  s.seq++;
+
+  // min/max в окне графика
+  queuePush(s, s.minQ, s.minHead, s.minLen, seq, value, true);
+  queuePush(s, s.maxQ, s.maxHead, s.maxLen, seq, value, false);
+  s.minVal = valueAt(s, s.minQ[s.minHead]);
+  s.maxVal = valueAt(s, s.maxQ[s.maxHead]);
+
+  // EMA с весом по прошедшему времени: при шаге TICK_SECONDS это ≈ 2/(N+1)
+  // для периода N тиков, а внеочередной тик сдвигает её едва-едва
+  for (int i = 0; i < EMA_COUNT; i++) {
+    s.emaPrev[i] = s.ema[i];
+    if (s.size == 1) {
+      s.ema[i] = value;
+    } else {
+      float alpha = 1.0f - expf(-2.0f * dt / EMA_PERIODS[i]);
+      s.ema[i] += alpha * (value - s.ema[i]);
+    }
+  }
+
+  volPush(s, seq, time);
+
+  s.change1h  = statsChange(s, 3600);
+  s.change24h = statsChange(s, 24 * 3600);
+}
+
+void statsFillTime(PriceStats& s, uint32_t time) {
+  int oldest = s.size - 1;
+  int zeroes = 0;
+  while (zeroes < s.size && statsTime(s, oldest - zeroes) == 0) zeroes++;
+  if (zeroes == 0) return;
+  if (zeroes < s.size) {
+    uint32_t next = statsTime(s, oldest - zeroes);
+    if (next < time) time = next;
+  }
+  for (int k = 0; k < zeroes; k++) s.times[ringIndex(s, oldest - k)] = time;
+
+  // Доходности в суммах посчитаны по старым dt — пересобираем окно и горизонты
+  uint32_t newest = statsTime(s, 0);
+  volRebuild(s, newest > VOL_WINDOW ? newest - VOL_WINDOW : 0);
+  volFinish(s);
+  s.change1h  = statsChange(s, 3600);
+  s.change24h = statsChange(s, 24 * 3600);
+}
+
+int statsTrend(const PriceStats& s) {
+  if (s.size < 2) return 0;
+  return statsValue(s, 0) >= s.ema[0] ? 1 : -1;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+
+// История цены одной монеты + статистика, которая обновляется на каждый тик
+// без пересчёта по всей истории: ни при отрисовке, ни при добавлении.
+// Горизонты (1 ч / 24 ч, EMA, волатильность) считаются по времени точек, а не
+// по числу тиков: внеочередные обновления (кнопка Refresh, смена монеты)
+// их не сдвигают.
+
+const uint32_t TICK_SECONDS  = 300;                        // обычный шаг данных — 5 минут
+const int      HISTORY_SLACK = 24;                         // внеочередных тиков за сутки без потери 24 ч
+const int      HISTORY_LEN   = 24 * 3600 / TICK_SECONDS + 1 + HISTORY_SLACK;  // 24 ч + точка отсчёта
+const int      CHART_POINTS  = 5;                          // окно min/max для графика
+const uint32_t VOL_WINDOW    = 3600;                       // волатильность за 1 ч, с
+
+// Допуск на дрожание планировщика при поиске точки "N секунд назад"
+const uint32_t STATS_TIME_SLACK = 30;
+
+// EMA на нескольких горизонтах (в секундах): 30 мин, 1 ч, 4 ч
+const int      EMA_COUNT = 3;
+const uint32_t EMA_PERIODS[EMA_COUNT] = { 1800, 3600, 14400 };
+
+struct PriceStats {
+  // Кольцевой буфер, head — куда ляжет следующая точка
+  float    values[HISTORY_LEN];
+  uint32_t times[HISTORY_LEN];   // unix-время точки, не убывает
+  uint16_t head;
+  uint16_t size;
+  uint32_t seq;                  // номер следующей точки с момента сброса
+
+  // Монотонные очереди номеров точек для min/max в окне CHART_POINTS
+  uint32_t minQ[CHART_POINTS];
+  uint32_t maxQ[CHART_POINTS];
+  uint8_t  minHead, minLen;
+  uint8_t  maxHead, maxLen;
+
+  // Взвешенные по dt суммы доходностей (%, приведённых к 5 минутам) за последние
+  // VOL_WINDOW секунд. volTail — номер самой старой точки, чья доходность
+  // (от предыдущей точки) в суммах
+  double   retWeight;
+  double   retSum;
+  double   retSumSq;
+  int      retCount;
+  uint32_t volTail;
+
+  // Кэш — читается графиком, веб-страницей и слайдом статистики
+  float minVal;
+  float maxVal;
+  float ema[EMA_COUNT];
+  float emaPrev[EMA_COUNT];   // EMA до последнего тика — для правил пересечения
+  float volatility;   // stddev доходности за 5 минут, %
+  float change1h;     // %, NAN пока нет часа истории
+  float change24h;    // %, NAN пока нет суток истории
+};
+
+void  statsReset(PriceStats& s);
+void  statsPush(PriceStats& s, float value, uint32_t time);
+
+// age = 0 — последняя точка (как было history[0]); 0, если точки ещё нет
+float    statsValue(const PriceStats& s, int age);
+uint32_t statsTime(const PriceStats& s, int age);
+
+// Изменение (%) от точки примерно за seconds до точки age к самой точке age.
+// NAN, если такой старой истории нет или в ней дыра больше четверти горизонта.
+// Двоичный поиск по времени — O(log HISTORY_LEN)
+float statsChange(const PriceStats& s, uint32_t seconds, int age = 0);
+
+// Проставить время точкам, добавленным до синхронизации часов (время 0).
+// Такие точки всегда самые старые; если после них уже есть точка с настоящим
+// временем (снимок лидера, Refresh), берётся не позже неё — порядок сохраняется
+void  statsFillTime(PriceStats& s, uint32_t time);
+
+// Тренд по короткой EMA: 1 — выше, -1 — ниже, 0 — данных мало
+int   statsTrend(const PriceStats& s);
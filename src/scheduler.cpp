@@ -0,0 +1,93 @@
+#include "scheduler.h"
+
+static SchedTask tasks[SCHED_MAX_TASKS];
+static int       taskCount = 0;
+
+static uint32_t periodStartUs = 0;
+static uint32_t idleUs        = 0;
+static uint16_t idlePermille  = 0;
+
+static bool isDue(const SchedTask& t, uint32_t now) {
+  return (int32_t)(now - t.nextDue) >= 0;
+}
+
+// Закрываем окно статистики: переводим накопленное в доли
+static void rollStats() {
+  uint32_t elapsed = micros() - periodStartUs;
+  if (elapsed < SCHED_STATS_PERIOD * 1000UL) return;
+
+  for (int i = 0; i < taskCount; i++) {
+    SchedTask& t = tasks[i];
+    t.sharePermille = (uint64_t)t.busyUs * 1000 / elapsed;
+    t.lastRuns      = t.runs;
+    t.lastMaxUs     = t.maxUs;
+    t.busyUs = 0;
+    t.runs   = 0;
+    t.maxUs  = 0;
+  }
+  idlePermille = (uint64_t)idleUs * 1000 / elapsed;
+  idleUs = 0;
+  periodStartUs += elapsed;
+}
+
+int schedAdd(const char* name, TaskFn fn, uint32_t firstDelayMs) {
+  if (taskCount >= SCHED_MAX_TASKS) return -1;
+
+  SchedTask& t = tasks[taskCount];
+  memset(&t, 0, sizeof(t));
+  t.name    = name;
+  t.fn      = fn;
+  t.nextDue = millis() + firstDelayMs;
+
+  if (taskCount == 0) periodStartUs = micros();
+  return taskCount++;
+}
+
+void schedTrigger(int id, uint32_t delayMs) {
+  if (id < 0 || id >= taskCount) return;
+  tasks[id].nextDue = millis() + delayMs;
+}
+
+void schedRun() {
+  for (int i = 0; i < taskCount; i++) {
+    SchedTask& t = tasks[i];
+    if (!isDue(t, millis())) continue;
+
+    uint32_t start = micros();
+    uint32_t wait  = t.fn();
+    uint32_t took  = micros() - start;
+
+    t.nextDue = millis() + wait;
+    t.busyUs += took;
+    t.runs++;
+    if (took > t.maxUs) t.maxUs = took;
+  }
+
+  // Спим до ближайшего дедлайна (задача могла разбудить другую — тогда не спим)
+  uint32_t now     = millis();
+  int32_t  sleepMs = (int32_t)SCHED_WAIT_TRIGGER;
+  for (int i = 0; i < taskCount; i++) {
+    int32_t left = (int32_t)(tasks[i].nextDue - now);
+    if (left < sleepMs) sleepMs = left;
+  }
+
+  if (sleepMs > 0) {
+    uint32_t start = micros();
+    delay(sleepMs);
+    idleUs += micros() - start;
+  }
+
+  rollStats();
+}
+
+int schedTaskCount() {
+  return taskCount;
+}
+
+const SchedTask& schedTask(int id) {
+  return tasks[id];
+}
+
+uint16_t schedIdlePermille() {
+  return idlePermille;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+
+// Кооперативный планировщик: каждая задача сама говорит, когда её звать снова.
+// Между дедлайнами loop() не крутится, а ждёт в delay(); долю простоя видно
+// на /tasks. Режим сна Wi-Fi — по умолчанию ядра (modem sleep).
+
+// Возвращает, через сколько мс вызвать задачу снова
+typedef uint32_t (*TaskFn)();
+
+const int      SCHED_MAX_TASKS    = 8;
+const uint32_t SCHED_WAIT_TRIGGER = 60000;   // "пока не разбудят" — задача ждёт schedTrigger()
+const uint32_t SCHED_STATS_PERIOD = 10000;   // окно статистики загрузки, мс
+
+struct SchedTask {
+  const char* name;
+  TaskFn      fn;
+  uint32_t    nextDue;     // millis() следующего запуска
+
+  // Накопление за текущее окно
+  uint32_t    busyUs;
+  uint32_t    runs;
+  uint32_t    maxUs;
+
+  // Итог прошлого окна
+  uint16_t    sharePermille;
+  uint32_t    lastRuns;
+  uint32_t    lastMaxUs;
+};
+
+// Возвращает id задачи или -1, если места нет
+int  schedAdd(const char* name, TaskFn fn, uint32_t firstDelayMs = 0);
+
+// Перенести запуск задачи: по умолчанию — на ближайший проход
+void schedTrigger(int id, uint32_t delayMs = 0);
+
+// Один проход: выполнить готовые задачи и уснуть до ближайшего дедлайна
+void schedRun();
+
+int              schedTaskCount();
+const SchedTask& schedTask(int id);
+uint16_t         schedIdlePermille();   // доля простоя за прошлое окно, ‰
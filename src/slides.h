@@ -0,0 +1,205 @@
+#pragma once
+#include <Arduino.h>
+#include "priceStats.h"
+#include "alerts.h"
+
+// Отрисовка слайдов в буфер дисплея. Шаблон по типу дисплея: на плате это
+// GyverOLED, в нативных тестах — эмулятор кадра (test/host/OledFrame.h).
+// Сам update() здесь не вызывается — его делает (и замеряет) вызывающий.
+
+const int totalSlides = 6;
+const int ALERT_SLIDE = totalSlides;  // вне ротации, показывается при срабатывании
+
+// Всё, что нужно для кадра, — без глобальных переменных прошивки
+struct SlideData {
+  const PriceStats* stats[2];
+  const char*       bases[2];      // "BTC", "ETH"
+  const char*       clock;         // "HH:MM"
+  const char*       city;
+  bool              haveWeather;
+  float             temperature;
+  const char*       weather;       // "Clouds"
+  const AlertRule*  alert;         // последнее сработавшее правило, nullptr — нет
+  float             alertPrice;
+};
+
+// Y точки графика; масштаб — по кэшированным min/max окна CHART_POINTS
+inline int chartY(const PriceStats& s, int age, int y0, float height) {
+  float span = s.maxVal - s.minVal;
+  if (span <= 0) span = 1.0f;  // чтобы не делить на 0
+  return y0 - (int)((statsValue(s, age) - s.minVal) * height / span);
+}
+
+// "+0.42%" или "--", пока истории не хватает
+inline void formatChange(char* out, size_t outLen, float pct) {
+  if (isnan(pct)) {
+    strlcpy(out, "--", outLen);
+  } else {
+    snprintf(out, outLen, "%+.2f%%", pct);
+  }
+}
+
+template <class Oled>
+void drawSlide(Oled& oled, int slide, const SlideData& d) {
+  oled.clear();
+
+  // Заголовок
+  oled.setScale(1);
+  oled.setCursor(0, 0);
+  oled.print(" Finance Monitor ");
+  oled.line(0, 10, 127, 10);
+
+  switch (slide) {
+    case 0:
+    case 1: {
+      // ===== Слайды 0 и 1: Crypto1 / Crypto2 =====
+      const PriceStats& s = *d.stats[slide];
+      oled.setScale(1);
+      oled.setCursor(0, 2);
+      oled.print("   ");
+      oled.print(d.bases[slide]);
+      oled.print(" / USDT");
+
+      oled.setScale(2);
+      oled.setCursor(10, 4);
+      if (s.size > 0) {
+        oled.print("$");
+        oled.print(statsValue(s, 0), 0);
+      } else {
+        oled.print("N/A");
+      }
+      break;
+    }
+
+    case 2: {
+      // ===== Слайд 2: Время =====
+      oled.setScale(1);
+      oled.setCursor(0, 2);
+      oled.print("   Time (NTP)");
+
+      oled.setScale(3);
+      oled.setCursor(10, 4);
+      oled.print(d.clock); // HH:MM
+      break;
+    }
+
+    case 3: {
+      // ===== Слайд 3: Погода =====
+      oled.setScale(1);
+      oled.setCursor(0, 2);
+      oled.print(d.city);
+
+      oled.setScale(3);
+      oled.setCursor(0, 4);
+      if (d.haveWeather) {
+        oled.print(d.temperature, 1);
+        oled.print("C");
+      } else {
+        oled.print("--.-C");
+      }
+
+      oled.setScale(1);
+      oled.setCursor(80, 2);
+      oled.print(d.weather);
+      break;
+    }
+
+    case 4: {
+      // ===== Слайд 4: График двух крипт =====
+      const PriceStats& s1 = *d.stats[0];
+      const PriceStats& s2 = *d.stats[1];
+      oled.setScale(1);
+      oled.setCursor(0, 1);
+      oled.print(d.bases[0]);
+      oled.print(" & ");
+      oled.print(d.bases[1]);
+      oled.print(" (5)");
+
+      int x0 = 5;
+      int y0 = 63;
+      oled.line(x0, 20, x0, y0);     // Y
+      oled.line(x0, y0, 127, y0);    // X
+
+      // Слева старые точки; тех, что ещё не накопились, не рисуем
+      // Линия Crypto1
+      for (int i = 0; i < CHART_POINTS - 1; i++) {
+        int age = CHART_POINTS - 1 - i;
+        if (age >= s1.size) continue;
+
+        int xp0 = x0 + 10 + i * 25;
+        int xp1 = x0 + 10 + (i + 1) * 25;
+
+        int yp0 = chartY(s1, age,     y0, 35.0f);
+        int yp1 = chartY(s1, age - 1, y0, 35.0f);
+
+        oled.line(xp0, yp0, xp1, yp1);
+      }
+
+      // Точки Crypto2
+      for (int i = 0; i < CHART_POINTS; i++) {
+        int age = CHART_POINTS - 1 - i;
+        if (age >= s2.size) continue;
+
+        int xp = x0 + 10 + i * 25;
+        int yp = chartY(s2, age, y0, 35.0f);
+        oled.dot(xp,   yp,   1);
+        oled.dot(xp+1, yp,   1);
+        oled.dot(xp,   yp+1, 1);
+        oled.dot(xp+1, yp+1, 1);
+      }
+
+      break;
+    }
+
+    case 5: {
+      // ===== Слайд 5: Статистика =====
+      char ch1h[10], ch24h[10];
+
+      oled.setScale(1);
+      for (int c = 0; c < 2; c++) {
+        const PriceStats& s = *d.stats[c];
+        int row = 2 + c * 3;
+        oled.setCursor(0, row);
+        oled.print(d.bases[c]);
+        oled.print(" EMA1h ");
+        oled.print(s.ema[1], 0);
+
+        formatChange(ch1h,  sizeof(ch1h),  s.change1h);
+        formatChange(ch24h, sizeof(ch24h), s.change24h);
+        oled.setCursor(0, row + 1);
+        oled.print(" 1h ");
+        oled.print(ch1h);
+        oled.print(" 24h ");
+        oled.print(ch24h);
+
+        oled.setCursor(0, row + 2);
+        oled.print(" vol ");
+        oled.print(s.volatility, 2);
+        oled.print("%/5m");
+      }
+      break;
+    }
+
+    case ALERT_SLIDE: {
+      // ===== Слайд оповещения =====
+      if (!d.alert) break;
+      char desc[24];
+      alertDescribe(*d.alert, desc, sizeof(desc));
+
+      oled.setScale(2);
+      oled.setCursor(16, 2);
+      oled.print("! ALERT");
+
+      oled.setScale(1);
+      oled.setCursor(0, 5);
+      oled.print(d.bases[d.alert->coin]);
+      oled.print(" ");
+      oled.print(desc);
+
+      oled.setCursor(0, 7);
+      oled.print("$");
+      oled.print(d.alertPrice, 2);
+      break;
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#include "timeService.h"
+#include <coredecls.h>   // settimeofday_cb
+#include <sys/time.h>
+
+static const char*   NTP_SERVER     = "pool.ntp.org";
+static const time_t  VALID_TIME     = 1600000000;  // всё, что раньше, — ещё не синхронизировано
+static const uint32_t UNSYNCED_POLL = 1000;        // как часто проверять синхронизацию, мс
+
+static struct tm     localNow;
+static bool          synced        = false;
+static uint32_t      nextCheckMs   = 0;
+static int           lastStamp     = -1;   // минута последнего события
+static MinuteHandler minuteHandler = nullptr;
+static AdjustHandler adjustHandler = nullptr;
+
+// SNTP или смена пояса сдвинули часы — пересчитать минуту на ближайшем тике
+static void forceRecheck() {
+  nextCheckMs = millis();
+  if (adjustHandler) adjustHandler();
+}
+
+void timeBegin(const char* tz) {
+  settimeofday_cb(forceRecheck);
+  configTime(tz, NTP_SERVER);
+  forceRecheck();
+}
+
+void timeSetZone(const char* tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+  forceRecheck();
+}
+
+void timeOnMinute(MinuteHandler handler) {
+  minuteHandler = handler;
+}
+
+void timeOnAdjust(AdjustHandler handler) {
+  adjustHandler = handler;
+}
+
+bool timeTick() {
+  if ((int32_t)(millis() - nextCheckMs) < 0) return false;
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+
+  if (tv.tv_sec < VALID_TIME) {
+    synced = false;
+    nextCheckMs = millis() + UNSYNCED_POLL;
+    return false;
+  }
+  synced = true;
+
+  localtime_r(&tv.tv_sec, &localNow);
+
+  // Дедлайн — следующая граница минуты по локальному тику
+  int32_t msToNext = (60 - localNow.tm_sec) * 1000L - tv.tv_usec / 1000;
+  if (msToNext < 0) msToNext = 0;  // секунда координации (tm_sec == 60)
+  nextCheckMs = millis() + msToNext;
+
+  // Перепроверка после синхронизации могла попасть в ту же минуту
+  int stamp = (localNow.tm_yday * 24 + localNow.tm_hour) * 60 + localNow.tm_min;
+  if (stamp == lastStamp) return false;
+  lastStamp = stamp;
+
+  if (minuteHandler) minuteHandler(localNow);
+  return true;
+}
+
+uint32_t timeMsToNextTick() {
+  int32_t left = (int32_t)(nextCheckMs - millis());
+  return left > 0 ? left : 0;
+}
+
+bool timeSynced() {
+  return synced;
+}
+
+uint32_t timeNowUtc() {
+  time_t now = time(nullptr);
+  return now < VALID_TIME ? 0 : (uint32_t)now;
+}
+
+const struct tm& timeLocal() {
+  return localNow;
+}
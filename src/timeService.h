@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+
+// Время на SNTP ядра ESP8266 + локальный тик по millis().
+// Между границами минут не делается ни разборов времени, ни аллокаций:
+// timeTick() сравнивает millis() с дедлайном и сразу выходит.
+
+typedef void (*MinuteHandler)(const struct tm& local);
+typedef void (*AdjustHandler)();
+
+// tz — POSIX-строка часового пояса, например "<+03>-3" или "CET-1CEST,M3.5.0,M10.5.0/3"
+void timeBegin(const char* tz);
+void timeSetZone(const char* tz);
+
+// Вызывать из loop(); true — наступила новая минута (и вызван обработчик)
+bool timeTick();
+
+// Сколько мс до следующей проверки — для планировщика
+uint32_t timeMsToNextTick();
+
+// Подписка на смену минуты (один обработчик)
+void timeOnMinute(MinuteHandler handler);
+
+// Подписка на сдвиг часов (синхронизация SNTP, смена пояса): дедлайн из
+// timeMsToNextTick() устарел, задачу часов надо разбудить сейчас
+void timeOnAdjust(AdjustHandler handler);
+
+bool            timeSynced();
+uint32_t        timeNowUtc();   // unix-время, 0 пока нет синхронизации
+const struct tm& timeLocal();   // локальное время на последней границе минуты
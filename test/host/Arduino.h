@@ -0,0 +1,73 @@
+#pragma once
+// Минимальная замена Arduino.h для нативных тестов (pio test -e native).
+// Только то, что используют модули из src/, попадающие в нативную сборку.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+typedef uint8_t byte;
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() {
+  return micros() / 1000;
+}
+
+// strlcpy есть в glibc только с 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size > 0) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+  }
+  return len;
+}
+#endif
+
+// Print: печать текста и чисел через write(uint8_t), как в ядре
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+
+  size_t write(const char* str) {
+    size_t n = 0;
+    while (*str) n += write((uint8_t)*str++);
+    return n;
+  }
+
+  size_t print(const char* str)   { return write(str); }
+  size_t print(char c)            { return write((uint8_t)c); }
+  size_t print(int n)             { return printf("%d", n); }
+  size_t print(unsigned n)        { return printf("%u", n); }
+  size_t print(long n)            { return printf("%ld", n); }
+  size_t print(unsigned long n)   { return printf("%lu", n); }
+  size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+
+  size_t println()                { return write("\r\n"); }
+  size_t println(const char* str) { return print(str) + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[64];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return write(buf);
+  }
+};
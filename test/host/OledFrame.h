@@ -0,0 +1,276 @@
+#pragma once
+// Эмулятор кадра OLED 128x64 для нативных тестов: то подмножество GyverOLED,
+// которым рисуют слайды (clear, print, setScale, setCursor, line, dot,
+// drawBitmap, update). Буфер устроен так же, как _oled_buffer в GyverOLED:
+// по 8 байт-страниц на столбец, бит — строка внутри страницы.
+// update() ничего не шлёт, а считает байты и горящие пиксели кадра.
+
+#include <Arduino.h>
+
+#ifndef BITMAP_NORMAL
+#define BITMAP_NORMAL 0
+#define BITMAP_INVERT 1
+#define BUF_ADD       0
+#define BUF_SUBTRACT  1
+#define BUF_REPLACE   2
+#endif
+
+class OledFrame : public Print {
+public:
+  static const int W = 128;
+  static const int H = 64;
+  static const uint32_t FRAME_BYTES = W * H / 8;  // update() шлёт весь буфер
+
+  uint8_t _oled_buffer[FRAME_BYTES];
+
+  // Счётчики update()
+  uint32_t updates     = 0;
+  uint32_t bytesPushed = 0;
+  uint32_t lastBytes   = 0;
+  uint16_t lastPixels  = 0;
+
+  OledFrame() { clear(); }
+
+  void init() {}
+  void invertDisplay(bool) {}
+  void setContrast(uint8_t) {}
+
+  void clear() {
+    memset(_oled_buffer, 0, sizeof(_oled_buffer));
+  }
+
+  void setScale(uint8_t scale) {
+    _scale = scale < 1 ? 1 : scale > 4 ? 4 : scale;
+  }
+
+  // x — в пикселях, y — номер строки-страницы (по 8 пикселей)
+  void setCursor(int x, int y) {
+    _x = x;
+    _y = y << 3;
+  }
+
+  // Символ 5x7 + столбец зазора, каждый пиксель — квадрат scale x scale
+  size_t write(uint8_t c) override {
+    if (c < 32 || c > 126) c = '?';
+    const uint8_t* glyph = FONT_5X7[c - 32];
+    for (int col = 0; col < 6; col++) {
+      uint8_t bits = col < 5 ? glyph[col] : 0;
+      for (int row = 0; row < 8; row++) {
+        if (!(bits & (1 << row))) continue;
+        for (int dx = 0; dx < _scale; dx++) {
+          for (int dy = 0; dy < _scale; dy++) {
+            dot(_x + col * _scale + dx, _y + row * _scale + dy, 1);
+          }
+        }
+      }
+    }
+    _x += 6 * _scale;
+    return 1;
+  }
+  using Print::write;
+
+  // fill: 1 — зажечь, 0 — погасить, 2 — инвертировать
+  void dot(int x, int y, uint8_t fill = 1) {
+    if (x < 0 || x >= W || y < 0 || y >= H) return;
+    uint8_t& b = _oled_buffer[(x << 3) + (y >> 3)];
+    uint8_t mask = 1 << (y & 7);
+    if (fill == 1)      b |= mask;
+    else if (fill == 0) b &= ~mask;
+    else                b ^= mask;
+  }
+
+  // Брезенхем
+  void line(int x0, int y0, int x1, int y1, uint8_t fill = 1) {
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+      dot(x0, y0, fill);
+      if (x0 == x1 && y0 == y1) break;
+      int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+  }
+
+  // Вертикальные байты построчно по страницам: frame[page * width + x]
+  void drawBitmap(int x, int y, const uint8_t* frame, int width, int height,
+                  uint8_t invert = BITMAP_NORMAL, uint8_t mode = BUF_ADD) {
+    for (int px = 0; px < width; px++) {
+      for (int py = 0; py < height; py++) {
+        uint8_t bits = pgm_read_byte(&frame[(py >> 3) * width + px]);
+        if (invert) bits = ~bits;
+        bool on = bits & (1 << (py & 7));
+        if (mode == BUF_REPLACE)       dot(x + px, y + py, on);
+        else if (on && mode == BUF_ADD) dot(x + px, y + py, 1);
+        else if (on)                    dot(x + px, y + py, 0);
+      }
+    }
+  }
+
+  void update() {
+    updates++;
+    lastBytes    = FRAME_BYTES;
+    bytesPushed += FRAME_BYTES;
+    lastPixels   = litPixels();
+  }
+
+  bool pixel(int x, int y) const {
+    return _oled_buffer[(x << 3) + (y >> 3)] & (1 << (y & 7));
+  }
+
+  uint16_t litPixels() const {
+    uint16_t n = 0;
+    for (uint32_t i = 0; i < FRAME_BYTES; i++) n += __builtin_popcount(_oled_buffer[i]);
+    return n;
+  }
+
+  // ASCII PBM (P1) — читаемые диффы эталонов в git
+  bool writePbm(const char* path) const {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "P1\n%d %d\n", W, H);
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) fputc(pixel(x, y) ? '1' : '0', f);
+      fputc('\n', f);
+    }
+    return fclose(f) == 0;
+  }
+
+  // P1 или P4 (как отдаёт /frame.pbm) размером 128x64
+  bool readPbm(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char magic[3] = { 0 };
+    int w = 0, h = 0;
+    bool ok = fscanf(f, "%2s %d %d", magic, &w, &h) == 3 && w == W && h == H;
+    if (ok) {
+      clear();
+      if (strcmp(magic, "P1") == 0) {
+        for (int i = 0; ok && i < W * H; i++) {
+          int c;
+          do c = fgetc(f); while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+          if (c != '0' && c != '1') ok = false;
+          else if (c == '1') dot(i % W, i / W, 1);
+        }
+      } else if (strcmp(magic, "P4") == 0) {
+        fgetc(f);  // один пробельный символ после заголовка
+        for (int y = 0; ok && y < H; y++) {
+          uint8_t row[W / 8];
+          ok = fread(row, 1, sizeof(row), f) == sizeof(row);
+          for (int x = 0; ok && x < W; x++) {
+            if (row[x >> 3] & (0x80 >> (x & 7))) dot(x, y, 1);
+          }
+        }
+      } else {
+        ok = false;
+      }
+    }
+    fclose(f);
+    return ok;
+  }
+
+private:
+  int     _x = 0;
+  int     _y = 0;
+  uint8_t _scale = 1;
+
+  // Классический шрифт 5x7, символы 32..126, по столбцам (бит 0 — верх)
+  static constexpr uint8_t FONT_5X7[95][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x00, 0x00, 0x5F, 0x00, 0x00 },  // !
+    { 0x00, 0x07, 0x00, 0x07, 0x00 },  // "
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 },  // #
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 },  // $
+    { 0x23, 0x13, 0x08, 0x64, 0x62 },  // %
+    { 0x36, 0x49, 0x56, 0x20, 0x50 },  // &
+    { 0x00, 0x08, 0x07, 0x03, 0x00 },  // '
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 },  // (
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 },  // )
+    { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A },  // *
+    { 0x08, 0x08, 0x3E, 0x08, 0x08 },  // +
+    { 0x00, 0x80, 0x70, 0x30, 0x00 },  // ,
+    { 0x08, 0x08, 0x08, 0x08, 0x08 },  // -
+    { 0x00, 0x00, 0x60, 0x60, 0x00 },  // .
+    { 0x20, 0x10, 0x08, 0x04, 0x02 },  // /
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E },  // 0
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 },  // 1
+    { 0x72, 0x49, 0x49, 0x49, 0x46 },  // 2
+    { 0x21, 0x41, 0x49, 0x4D, 0x33 },  // 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 },  // 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 },  // 5
+    { 0x3C, 0x4A, 0x49, 0x49, 0x31 },  // 6
+    { 0x41, 0x21, 0x11, 0x09, 0x07 },  // 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 },  // 8
+    { 0x46, 0x49, 0x49, 0x29, 0x1E },  // 9
+    { 0x00, 0x36, 0x36, 0x00, 0x00 },  // :
+    { 0x00, 0x56, 0x36, 0x00, 0x00 },  // ;
+    { 0x08, 0x14, 0x22, 0x41, 0x00 },  // <
+    { 0x14, 0x14, 0x14, 0x14, 0x14 },  // =
+    { 0x00, 0x41, 0x22, 0x14, 0x08 },  // >
+    { 0x02, 0x01, 0x59, 0x09, 0x06 },  // ?
+    { 0x3E, 0x41, 0x5D, 0x59, 0x4E },  // @
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C },  // A
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 },  // B
+    { 0x3E, 0x41, 0x41, 0x41, 0x22 },  // C
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E },  // D
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 },  // E
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 },  // F
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 },  // G
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F },  // H
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 },  // I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 },  // J
+    { 0x7F, 0x08, 0x14, 0x22, 0x41 },  // K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 },  // L
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F },  // M
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F },  // N
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E },  // O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 },  // P
+    { 0x3E, 0x41, 0x51, 0x21, 0x5E },  // Q
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 },  // R
+    { 0x26, 0x49, 0x49, 0x49, 0x32 },  // S
+    { 0x03, 0x01, 0x7F, 0x01, 0x03 },  // T
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F },  // U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F },  // V
+    { 0x3F, 0x40, 0x38, 0x40, 0x3F },  // W
+    { 0x63, 0x14, 0x08, 0x14, 0x63 },  // X
+    { 0x03, 0x04, 0x78, 0x04, 0x03 },  // Y
+    { 0x61, 0x59, 0x49, 0x4D, 0x43 },  // Z
+    { 0x00, 0x7F, 0x41, 0x41, 0x41 },  // [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 },  // '\'
+    { 0x00, 0x41, 0x41, 0x41, 0x7F },  // ]
+    { 0x04, 0x02, 0x01, 0x02, 0x04 },  // ^
+    { 0x40, 0x40, 0x40, 0x40, 0x40 },  // _
+    { 0x00, 0x03, 0x07, 0x08, 0x00 },  // `
+    { 0x20, 0x54, 0x54, 0x78, 0x40 },  // a
+    { 0x7F, 0x28, 0x44, 0x44, 0x38 },  // b
+    { 0x38, 0x44, 0x44, 0x44, 0x28 },  // c
+    { 0x38, 0x44, 0x44, 0x28, 0x7F },  // d
+    { 0x38, 0x54, 0x54, 0x54, 0x18 },  // e
+    { 0x00, 0x08, 0x7E, 0x09, 0x02 },  // f
+    { 0x18, 0xA4, 0xA4, 0x9C, 0x78 },  // g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 },  // h
+    { 0x00, 0x44, 0x7D, 0x40, 0x00 },  // i
+    { 0x20, 0x40, 0x40, 0x3D, 0x00 },  // j
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 },  // k
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 },  // l
+    { 0x7C, 0x04, 0x78, 0x04, 0x78 },  // m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 },  // n
+    { 0x38, 0x44, 0x44, 0x44, 0x38 },  // o
+    { 0xFC, 0x18, 0x24, 0x24, 0x18 },  // p
+    { 0x18, 0x24, 0x24, 0x18, 0xFC },  // q
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 },  // r
+    { 0x48, 0x54, 0x54, 0x54, 0x24 },  // s
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 },  // t
+    { 0x3C, 0x40, 0x40, 0x20, 0x7C },  // u
+    { 0x1C, 0x20, 0x40, 0x20, 0x1C },  // v
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C },  // w
+    { 0x44, 0x28, 0x10, 0x28, 0x44 },  // x
+    { 0x4C, 0x90, 0x90, 0x90, 0x7C },  // y
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 },  // z
+    { 0x00, 0x08, 0x36, 0x41, 0x00 },  // {
+    { 0x00, 0x00, 0x77, 0x00, 0x00 },  // |
+    { 0x00, 0x41, 0x36, 0x08, 0x00 },  // }
+    { 0x02, 0x01, 0x02, 0x04, 0x02 },  // ~
+  };
+};
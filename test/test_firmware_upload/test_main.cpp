@@ -0,0 +1,280 @@
+// Нативный тест приёма прошивки (src/firmwareUpload.h) от START до END
+// на эмуляторе flash с поведением Updater из ядра ESP8266:
+// begin() не проходит, пока предыдущая загрузка не закрыта через end();
+// end(true) проверяет MD5 и заголовок образа (0xE9 или gzip 1F 8B).
+//
+//   pio test -e native -f test_firmware_upload
+
+#include <unity.h>
+#include <firmwareUpload.h>
+#include <vector>
+
+// ===== MD5 (RFC 1321) — эталон для проверки на end() =====
+static void md5Hex(const uint8_t* data, size_t len, char out[33]) {
+  static const uint8_t R[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+  };
+  uint32_t K[64];
+  for (int i = 0; i < 64; i++) K[i] = (uint32_t)(fabs(sin(i + 1.0)) * 4294967296.0);
+
+  // Дополнение: 0x80, нули, длина в битах (little-endian)
+  std::vector<uint8_t> msg(data, data + len);
+  msg.push_back(0x80);
+  while (msg.size() % 64 != 56) msg.push_back(0);
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 0; i < 8; i++) msg.push_back((uint8_t)(bits >> (8 * i)));
+
+  uint32_t h[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+  for (size_t off = 0; off < msg.size(); off += 64) {
+    uint32_t M[16];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &msg[off + i * 4];
+      M[i] = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+    for (int i = 0; i < 64; i++) {
+      uint32_t f;
+      int g;
+      if (i < 16)      { f = (b & c) | (~b & d); g = i; }
+      else if (i < 32) { f = (d & b) | (~d & c); g = (5 * i + 1) % 16; }
+      else if (i < 48) { f = b ^ c ^ d;          g = (3 * i + 5) % 16; }
+      else             { f = c ^ (b | ~d);       g = (7 * i) % 16; }
+      f += a + K[i] + M[g];
+      a = d; d = c; c = b;
+      b += (f << R[i]) | (f >> (32 - R[i]));
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+  }
+  for (int i = 0; i < 16; i++) {
+    snprintf(out + i * 2, 3, "%02x", (h[i / 4] >> (8 * (i % 4))) & 0xFF);
+  }
+}
+
+// ===== Эмулятор flash с интерфейсом UpdaterClass =====
+struct FakeFlash {
+  enum { ERR_NONE, ERR_RUNNING, ERR_SPACE, ERR_WRITE, ERR_MD5, ERR_MAGIC };
+
+  size_t capacity = 256 * 1024;   // свободное место под новый скетч
+  size_t failAt   = 0;            // write() сломается на этом смещении (0 — никогда)
+
+  std::vector<uint8_t> staged;    // то, что пишется сейчас
+  std::vector<uint8_t> installed; // образ, поставленный на установку
+  size_t size     = 0;            // 0 — не запущен
+  char   md5[33]  = "";
+  int    error    = ERR_NONE;
+  int    endCalls = 0;
+
+  bool isRunning() const { return size > 0; }
+  bool hasError() const  { return error != ERR_NONE; }
+
+  bool begin(size_t maxSize) {
+    if (isRunning()) { error = ERR_RUNNING; return false; }
+    error = ERR_NONE;
+    if (maxSize == 0 || maxSize > capacity) { error = ERR_SPACE; return false; }
+    staged.clear();
+    md5[0] = 0;
+    size = maxSize;
+    return true;
+  }
+
+  bool setMD5(const char* expected) {
+    if (strlen(expected) != 32) return false;
+    strlcpy(md5, expected, sizeof(md5));
+    return true;
+  }
+
+  size_t write(uint8_t* data, size_t len) {
+    if (hasError() || !isRunning()) return 0;
+    if (staged.size() + len > size) { error = ERR_SPACE; return 0; }
+    if (failAt && staged.size() + len > failAt) { error = ERR_WRITE; return 0; }
+    staged.insert(staged.end(), data, data + len);
+    return len;
+  }
+
+  bool end(bool evenIfRemaining = false) {
+    endCalls++;
+    if (!isRunning()) return false;
+    if (hasError() || (staged.size() < size && !evenIfRemaining)) {
+      reset();
+      return false;
+    }
+    if (md5[0]) {
+      char actual[33];
+      md5Hex(staged.data(), staged.size(), actual);
+      if (strcmp(actual, md5) != 0) { error = ERR_MD5; reset(); return false; }
+    }
+    bool plain = staged.size() > 0 && staged[0] == 0xE9;
+    bool gzip  = staged.size() > 1 && staged[0] == 0x1F && staged[1] == 0x8B;
+    if (!plain && !gzip) { error = ERR_MAGIC; reset(); return false; }
+
+    installed = staged;
+    reset();
+    return true;
+  }
+
+  void reset() {
+    staged.clear();
+    size   = 0;
+    md5[0] = 0;
+  }
+};
+
+static FakeFlash                 flash;
+static FirmwareUpload<FakeFlash> upload(flash);
+
+const size_t MAX_SIZE  = 128 * 1024;
+const size_t CHUNK_LEN = 2048;    // HTTP_UPLOAD_BUFLEN в ESP8266WebServer
+
+// Псевдо-gzip: заголовок gzip + детерминированный "сжатый" поток.
+// Распаковывает загрузчик при установке, flash проверяет только заголовок.
+static std::vector<uint8_t> makeGzipImage(size_t len) {
+  std::vector<uint8_t> img(len);
+  const uint8_t header[10] = { 0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x02, 0x03 };
+  memcpy(img.data(), header, sizeof(header));
+  uint32_t x = 12345;
+  for (size_t i = sizeof(header); i < len; i++) {
+    x = x * 1103515245 + 12345;
+    img[i] = (uint8_t)(x >> 16);
+  }
+  return img;
+}
+
+// Вся загрузка, как её видит handleUpdateUpload: START, WRITE кусками, END
+static bool uploadImage(std::vector<uint8_t> img, const char* md5) {
+  upload.start(MAX_SIZE, md5);
+  for (size_t off = 0; off < img.size(); off += CHUNK_LEN) {
+    size_t n = img.size() - off < CHUNK_LEN ? img.size() - off : CHUNK_LEN;
+    upload.write(&img[off], n);
+  }
+  return upload.finish();
+}
+
+void setUp() {
+  flash = FakeFlash();
+}
+
+void tearDown() {}
+
+void test_md5_reference() {
+  char out[33];
+  md5Hex((const uint8_t*)"", 0, out);
+  TEST_ASSERT_EQUAL_STRING("d41d8cd98f00b204e9800998ecf8427e", out);
+  md5Hex((const uint8_t*)"abc", 3, out);
+  TEST_ASSERT_EQUAL_STRING("900150983cd24fb0d6963f7d28e17f72", out);
+}
+
+void test_gzip_image_lands_intact() {
+  std::vector<uint8_t> img = makeGzipImage(3 * CHUNK_LEN + 777);
+  char md5[33];
+  md5Hex(img.data(), img.size(), md5);
+
+  TEST_ASSERT_TRUE(uploadImage(img, md5));
+  TEST_ASSERT_TRUE(upload.ok());
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_EQUAL(img.size(), flash.installed.size());
+  TEST_ASSERT_EQUAL_MEMORY(img.data(), flash.installed.data(), img.size());
+}
+
+void test_without_md5() {
+  std::vector<uint8_t> img = makeGzipImage(5000);
+  TEST_ASSERT_TRUE(uploadImage(img, nullptr));
+  TEST_ASSERT_EQUAL(img.size(), flash.installed.size());
+}
+
+void test_md5_mismatch_then_retry() {
+  std::vector<uint8_t> img = makeGzipImage(5000);
+  TEST_ASSERT_FALSE(uploadImage(img, "00000000000000000000000000000000"));
+  TEST_ASSERT_EQUAL(FakeFlash::ERR_MD5, flash.error);
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_TRUE(flash.installed.empty());
+
+  char md5[33];
+  md5Hex(img.data(), img.size(), md5);
+  TEST_ASSERT_TRUE(uploadImage(img, md5));
+}
+
+// Раньше после неудачного setMD5 end() не вызывался и Updater оставался запущенным
+void test_bad_md5_argument_releases_updater() {
+  std::vector<uint8_t> img = makeGzipImage(5000);
+  TEST_ASSERT_FALSE(uploadImage(img, "abc"));
+  TEST_ASSERT_EQUAL(1, flash.endCalls);
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_TRUE(flash.installed.empty());
+
+  TEST_ASSERT_TRUE(uploadImage(img, nullptr));
+}
+
+void test_write_failure_then_retry() {
+  std::vector<uint8_t> img = makeGzipImage(4 * CHUNK_LEN);
+  flash.failAt = 2 * CHUNK_LEN + 100;
+  TEST_ASSERT_FALSE(uploadImage(img, nullptr));
+  TEST_ASSERT_EQUAL(FakeFlash::ERR_WRITE, flash.error);
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_TRUE(flash.installed.empty());
+
+  flash.failAt = 0;
+  TEST_ASSERT_TRUE(uploadImage(img, nullptr));
+  TEST_ASSERT_EQUAL_MEMORY(img.data(), flash.installed.data(), img.size());
+}
+
+void test_not_an_image() {
+  std::vector<uint8_t> img(3000, 0x42);
+  TEST_ASSERT_FALSE(uploadImage(img, nullptr));
+  TEST_ASSERT_EQUAL(FakeFlash::ERR_MAGIC, flash.error);
+  TEST_ASSERT_FALSE(flash.isRunning());
+}
+
+void test_image_too_large() {
+  std::vector<uint8_t> img = makeGzipImage(MAX_SIZE + 1);
+  TEST_ASSERT_FALSE(uploadImage(img, nullptr));
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_TRUE(flash.installed.empty());
+}
+
+void test_begin_failure_skips_end() {
+  flash.capacity = MAX_SIZE / 2;
+  TEST_ASSERT_FALSE(uploadImage(makeGzipImage(1000), nullptr));
+  TEST_ASSERT_FALSE(upload.begun());
+  TEST_ASSERT_EQUAL(0, flash.endCalls);
+}
+
+void test_abort_then_retry() {
+  std::vector<uint8_t> img = makeGzipImage(3 * CHUNK_LEN);
+  upload.start(MAX_SIZE, nullptr);
+  upload.write(&img[0], CHUNK_LEN);
+  upload.abort();
+  TEST_ASSERT_FALSE(upload.ok());
+  TEST_ASSERT_FALSE(flash.isRunning());
+  TEST_ASSERT_TRUE(flash.installed.empty());
+
+  TEST_ASSERT_TRUE(uploadImage(img, nullptr));
+}
+
+// Клиент отвалился без ABORTED — новая загрузка закрывает старую
+void test_restart_without_end() {
+  std::vector<uint8_t> img = makeGzipImage(3 * CHUNK_LEN);
+  upload.start(MAX_SIZE, nullptr);
+  upload.write(&img[0], CHUNK_LEN);
+
+  TEST_ASSERT_TRUE(uploadImage(img, nullptr));
+  TEST_ASSERT_EQUAL(img.size(), flash.installed.size());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_md5_reference);
+  RUN_TEST(test_gzip_image_lands_intact);
+  RUN_TEST(test_without_md5);
+  RUN_TEST(test_md5_mismatch_then_retry);
+  RUN_TEST(test_bad_md5_argument_releases_updater);
+  RUN_TEST(test_write_failure_then_retry);
+  RUN_TEST(test_not_an_image);
+  RUN_TEST(test_image_too_large);
+  RUN_TEST(test_begin_failure_skips_end);
+  RUN_TEST(test_abort_then_retry);
+  RUN_TEST(test_restart_without_end);
+  return UNITY_END();
+}
@@ -0,0 +1,247 @@
+// Нативный тест обмена по локалке (src/lanProtocol.*): один лидер и несколько
+// ведомых на общей шине в памяти, время — виртуальные миллисекунды.
+// Узел повторяет логику main.cpp: data-задача раз в 5 минут, heartbeat лидера
+// раз в 30 с, приём снимков ведомыми.
+//
+//   pio test -e native -f test_lan
+
+#include <unity.h>
+#include <lanProtocol.h>
+#include <vector>
+
+const uint32_t DATA_INTERVAL = 300000;
+const uint32_t STEP_MS       = 1000;
+const uint32_t START_TIME    = 1700000000;
+
+struct Node {
+  bool        leader;
+  const char* symbol1;
+  const char* symbol2;
+  const char* city;
+  uint32_t    dataPhaseMs;       // сдвиг data-задачи относительно лидера
+
+  LanState st;
+  bool     upstreamOk = true;    // Binance отвечает (для любого узла)
+  bool     powered    = true;
+  bool     dropRx     = false;   // ведомый теряет входящие пакеты
+  int      ownFetches = 0;       // сам сходил в Binance
+  int      lanTicks   = 0;       // взял цены из снимка лидера
+  uint32_t lastTickTime = 0;     // unix-время последнего тика из локалки
+};
+
+static std::vector<Node>        nodes;
+static std::vector<LanSnapshot> bus;
+static uint32_t                 nowMs;
+static uint32_t                 unixTime;
+
+static Node& addNode(bool leader, const char* s1 = "BTCUSDT", const char* s2 = "ETHUSDT",
+                     uint32_t phaseMs = 0) {
+  Node n = { leader, s1, s2, "Hrodna", phaseMs, {} };
+  lanReset(n.st);
+  nodes.push_back(n);
+  return nodes.back();
+}
+
+static void send(const LanSnapshot& snap) {
+  LanSnapshot packet = snap;
+  lanEncode(packet);
+  bus.push_back(packet);
+}
+
+// updateData() + lanPublish()
+static void dataTask(Node& n) {
+  if (!n.leader && lanCoversCrypto(n.st, nowMs, n.symbol1, n.symbol2)) return;
+  if (!n.upstreamOk) return;
+  n.ownFetches++;
+  if (!n.leader) return;
+
+  LanSnapshot snap;
+  memset(&snap, 0, sizeof(snap));
+  snap.time   = unixTime;
+  strlcpy(snap.symbol1, n.symbol1, sizeof(snap.symbol1));
+  snap.price1 = 65000.0f;
+  strlcpy(snap.symbol2, n.symbol2, sizeof(snap.symbol2));
+  snap.price2 = 3400.0f;
+  snap.weatherValid = true;
+  strlcpy(snap.city, n.city, sizeof(snap.city));
+  lanLeaderUpdate(n.st, snap, nowMs);
+  send(n.st.last);
+}
+
+// taskLanHeartbeat()
+static void heartbeatTask(Node& n) {
+  if (n.leader && lanFresh(n.st, nowMs)) send(n.st.last);
+}
+
+// taskNetwork() -> onLanSnapshot()
+static void deliver() {
+  for (const LanSnapshot& packet : bus) {
+    for (Node& n : nodes) {
+      if (n.leader || !n.powered || n.dropRx) continue;
+      LanSnapshot snap = packet;
+      if (!lanDecode(snap)) continue;
+      if (!lanFollowerAccept(n.st, snap, nowMs)) continue;
+      if (lanCoversCrypto(n.st, nowMs, n.symbol1, n.symbol2)) {
+        n.lanTicks++;
+        n.lastTickTime = snap.time;
+      }
+    }
+  }
+  bus.clear();
+}
+
+static void run(uint32_t durationMs) {
+  for (uint32_t end = nowMs + durationMs; nowMs < end; nowMs += STEP_MS) {
+    unixTime = START_TIME + nowMs / 1000;
+    for (Node& n : nodes) {
+      if (!n.powered) continue;
+      if ((nowMs + DATA_INTERVAL - n.dataPhaseMs) % DATA_INTERVAL == 0) dataTask(n);
+      if (nowMs % LAN_HEARTBEAT_INTERVAL == 0) heartbeatTask(n);
+    }
+    deliver();
+  }
+}
+
+void setUp() {
+  nodes.clear();
+  nodes.reserve(8);
+  bus.clear();
+  nowMs    = 0;
+  unixTime = START_TIME;
+}
+
+void tearDown() {}
+
+void test_decode_checks_magic_and_terminators() {
+  LanSnapshot snap;
+  memset(&snap, 'x', sizeof(snap));
+  TEST_ASSERT_FALSE(lanDecode(snap));
+
+  lanEncode(snap);
+  TEST_ASSERT_TRUE(lanDecode(snap));
+  TEST_ASSERT_EQUAL(sizeof(snap.symbol1) - 1, strlen(snap.symbol1));
+  TEST_ASSERT_EQUAL(sizeof(snap.city) - 1, strlen(snap.city));
+  TEST_ASSERT_EQUAL(sizeof(snap.weather) - 1, strlen(snap.weather));
+}
+
+void test_freshness_survives_millis_wrap() {
+  LanState st;
+  lanReset(st);
+  LanSnapshot snap;
+  memset(&snap, 0, sizeof(snap));
+  lanLeaderUpdate(st, snap, 0xFFFFF000u);
+  TEST_ASSERT_TRUE(lanFresh(st, 0x00001000u));
+  TEST_ASSERT_FALSE(lanFresh(st, 0xFFFFF000u + LAN_LEADER_TIMEOUT));
+}
+
+// Живой лидер: ведомые сами не ходят, каждый новый снимок — ровно один тик
+void test_followers_use_leader() {
+  addNode(true);
+  for (int i = 0; i < 3; i++) addNode(false, "BTCUSDT", "ETHUSDT", 60000 + i * 1000);
+
+  run(2 * 3600 * 1000);
+
+  const Node& leader = nodes[0];
+  for (size_t i = 1; i < nodes.size(); i++) {
+    TEST_ASSERT_EQUAL(0, nodes[i].ownFetches);
+    TEST_ASSERT_EQUAL(leader.ownFetches, nodes[i].lanTicks);
+  }
+}
+
+// Лидер в сети, но Binance у него не отвечает: heartbeat со старым снимком
+// не должен держать ведомых — они переходят на свои запросы
+void test_stale_leader_falls_back() {
+  addNode(true);
+  addNode(false, "BTCUSDT", "ETHUSDT", 60000);
+  addNode(false, "BTCUSDT", "ETHUSDT", 120000);
+
+  run(3600 * 1000);
+  TEST_ASSERT_EQUAL(0, nodes[1].ownFetches);
+
+  nodes[0].upstreamOk = false;
+  uint32_t lastFresh = nodes[0].st.freshMs;
+  run(LAN_LEADER_TIMEOUT + DATA_INTERVAL);
+
+  TEST_ASSERT_FALSE(lanFresh(nodes[0].st, nowMs));
+  for (size_t i = 1; i < nodes.size(); i++) {
+    TEST_ASSERT_GREATER_THAN(0, nodes[i].ownFetches);
+    TEST_ASSERT_FALSE(lanFresh(nodes[i].st, nowMs));
+  }
+  TEST_ASSERT_TRUE(nowMs - lastFresh >= LAN_LEADER_TIMEOUT);
+
+  // Лидер снова получает цены — ведомые возвращаются к нему
+  nodes[0].upstreamOk = true;
+  run(DATA_INTERVAL);
+  int fetches = nodes[1].ownFetches;
+  run(3600 * 1000);
+  TEST_ASSERT_EQUAL(fetches, nodes[1].ownFetches);
+}
+
+void test_leader_powered_off() {
+  addNode(true);
+  addNode(false, "BTCUSDT", "ETHUSDT", 60000);
+
+  run(3600 * 1000);
+  nodes[0].powered = false;
+  run(LAN_LEADER_TIMEOUT + DATA_INTERVAL);
+
+  TEST_ASSERT_GREATER_THAN(0, nodes[1].ownFetches);
+}
+
+// Другие монеты — лидер не подходит, ведомый качает сам
+void test_follower_with_other_coins() {
+  addNode(true);
+  addNode(false, "BTCUSDT", "ETHUSDT", 60000);
+  addNode(false, "SOLUSDT", "ETHUSDT", 60000);
+
+  run(3600 * 1000);
+
+  TEST_ASSERT_EQUAL(0, nodes[1].ownFetches);
+  TEST_ASSERT_EQUAL(0, nodes[2].lanTicks);
+  TEST_ASSERT_EQUAL(12, nodes[2].ownFetches);
+}
+
+// Пропущенный снимок приходит с ближайшим heartbeat и считается новым один раз
+void test_missed_snapshot_arrives_with_heartbeat() {
+  addNode(true);
+  addNode(false, "BTCUSDT", "ETHUSDT", 60000);
+
+  run(DATA_INTERVAL + STEP_MS);
+  int ticks = nodes[1].lanTicks;
+
+  nodes[1].dropRx = true;
+  run(DATA_INTERVAL);                  // новый снимок потерян
+  nodes[1].dropRx = false;
+  run(2 * LAN_HEARTBEAT_INTERVAL);     // два повтора — один тик
+
+  TEST_ASSERT_EQUAL(ticks + 1, nodes[1].lanTicks);
+  TEST_ASSERT_EQUAL(nodes[0].st.last.time, nodes[1].lastTickTime);
+}
+
+// После перезагрузки лидер снова начинает seq с 1 — снимок всё равно новый
+void test_leader_reboot_resets_seq() {
+  addNode(true);
+  addNode(false, "BTCUSDT", "ETHUSDT", 60000);
+
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(1, nodes[1].lanTicks);
+  TEST_ASSERT_EQUAL(1u, nodes[1].st.last.seq);
+
+  lanReset(nodes[0].st);
+  run(DATA_INTERVAL);
+  TEST_ASSERT_EQUAL(1u, nodes[1].st.last.seq);
+  TEST_ASSERT_EQUAL(2, nodes[1].lanTicks);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_decode_checks_magic_and_terminators);
+  RUN_TEST(test_freshness_survives_millis_wrap);
+  RUN_TEST(test_followers_use_leader);
+  RUN_TEST(test_stale_leader_falls_back);
+  RUN_TEST(test_leader_powered_off);
+  RUN_TEST(test_follower_with_other_coins);
+  RUN_TEST(test_missed_snapshot_arrives_with_heartbeat);
+  RUN_TEST(test_leader_reboot_resets_seq);
+  return UNITY_END();
+}
@@ -0,0 +1,332 @@
+// Нативный тест статистики цены (src/priceStats.*): монотонные очереди min/max
+// и скользящая дисперсия против пересчёта "в лоб", горизонты по времени точек.
+//
+//   pio test -e native -f test_price_stats
+
+#include <unity.h>
+#include <priceStats.h>
+#include <alerts.h>
+
+static PriceStats s;
+static uint32_t   rng;
+
+const uint32_t T0 = 1700000000;
+
+static uint32_t nextRand() {
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 8;
+}
+
+// ===== Пересчёт "в лоб" по кольцу =====
+static void bruteMinMax(float& mn, float& mx) {
+  int n = s.size < CHART_POINTS ? s.size : CHART_POINTS;
+  mn = mx = statsValue(s, 0);
+  for (int age = 1; age < n; age++) {
+    float v = statsValue(s, age);
+    if (v < mn) mn = v;
+    if (v > mx) mx = v;
+  }
+}
+
+// Взвешенная по dt дисперсия доходностей, приведённых к TICK_SECONDS, за VOL_WINDOW
+static double bruteVolatility() {
+  uint32_t now  = statsTime(s, 0);
+  uint32_t from = now > VOL_WINDOW ? now - VOL_WINDOW : 0;
+  double w = 0, sum = 0, sumSq = 0;
+  int    count = 0;
+  for (int age = 0; age + 1 < s.size && statsTime(s, age) > from; age++) {
+    float    prev = statsValue(s, age + 1);
+    uint32_t dt   = statsTime(s, age) - statsTime(s, age + 1);
+    if (prev <= 0 || dt == 0) continue;
+    double z = (statsValue(s, age) - prev) / prev * 100.0 * sqrt((double)TICK_SECONDS / dt);
+    w     += dt;
+    sum   += dt * z;
+    sumSq += dt * z * z;
+    count++;
+  }
+  if (count < 2) return 0.0;
+  double mean = sum / w;
+  double var  = sumSq / w - mean * mean;
+  return var > 0 ? sqrt(var) : 0.0;
+}
+
+// Самая новая точка не позже "seconds назад" (с допуском), линейным проходом
+static float bruteChange(uint32_t seconds) {
+  uint32_t now = statsTime(s, 0);
+  for (int age = 1; age < s.size; age++) {
+    uint32_t t = statsTime(s, age);
+    if (t > now - seconds + STATS_TIME_SLACK) continue;
+    if (t + seconds / 4 < now - seconds) return NAN;
+    return (statsValue(s, 0) - statsValue(s, age)) / statsValue(s, age) * 100.0f;
+  }
+  return NAN;
+}
+
+static void assertVolatility() {
+  double expected = bruteVolatility();
+  TEST_ASSERT_DOUBLE_WITHIN(1e-6 + expected * 1e-6, expected, s.volatility);
+}
+
+void setUp() {
+  statsReset(s);
+  rng = 42;
+}
+
+void tearDown() {}
+
+// Случайные цены с повторами, история прокручивается через кольцо несколько раз
+void test_min_max_queues_match_brute_force() {
+  for (int i = 0; i < 4 * HISTORY_LEN; i++) {
+    float value = 100.0f + (nextRand() % 16);   // мало разных значений — много равных
+    statsPush(s, value, T0 + i * TICK_SECONDS);
+
+    float mn, mx;
+    bruteMinMax(mn, mx);
+    TEST_ASSERT_EQUAL_FLOAT(mn, s.minVal);
+    TEST_ASSERT_EQUAL_FLOAT(mx, s.maxVal);
+  }
+}
+
+void test_min_max_monotonic_series() {
+  for (int i = 0; i < 20; i++) {
+    statsPush(s, 100.0f + i, T0 + i * TICK_SECONDS);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f + i, s.maxVal);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f + (i < CHART_POINTS ? 0 : i - CHART_POINTS + 1), s.minVal);
+  }
+}
+
+// Ровный шаг: то же, что обычное стандартное отклонение последних 12 доходностей
+void test_volatility_regular_ticks() {
+  float prices[40];
+  for (int i = 0; i < 40; i++) {
+    prices[i] = 1000.0f * (1.0f + 0.01f * sinf(i * 0.7f)) + (nextRand() % 100) * 0.1f;
+    statsPush(s, prices[i], T0 + i * TICK_SECONDS);
+  }
+
+  int n = VOL_WINDOW / TICK_SECONDS;
+  double sum = 0, sumSq = 0;
+  for (int i = 40 - n; i < 40; i++) {
+    double r = (prices[i] - prices[i - 1]) / prices[i - 1] * 100.0;
+    sum   += r;
+    sumSq += r * r;
+  }
+  double mean = sum / n;
+  TEST_ASSERT_DOUBLE_WITHIN(1e-4, sqrt(sumSq / n - mean * mean), s.volatility);
+}
+
+// Неровный шаг: внеочередные тики, повторы с тем же временем, дыры в данных
+void test_volatility_irregular_ticks_match_brute_force() {
+  uint32_t t = T0;
+  float price = 30000.0f;
+  for (int i = 0; i < 3 * HISTORY_LEN; i++) {
+    switch (nextRand() % 8) {
+      case 0:  t += 0;    break;                      // то же время
+      case 1:  t += 3 + nextRand() % 30; break;       // Refresh сразу после тика
+      case 2:  t += 900 + nextRand() % 3600; break;   // пропуски
+      default: t += TICK_SECONDS + nextRand() % 5; break;
+    }
+    price *= 1.0f + ((int)(nextRand() % 201) - 100) * 0.0001f;
+    statsPush(s, price, t);
+    assertVolatility();
+  }
+}
+
+// Сотни тиков за час вытесняют начало окна из кольца — суммы пересчитываются
+void test_volatility_burst_rebuilds_window() {
+  uint32_t t = T0;
+  float price = 500.0f;
+  for (int i = 0; i < 2 * HISTORY_LEN; i++) {
+    t += i % 3 == 0 ? 1 : 7;
+    price += ((int)(nextRand() % 11) - 5) * 0.01f;
+    statsPush(s, price, t);
+    assertVolatility();
+  }
+  for (int i = 0; i < 30; i++) {
+    t += TICK_SECONDS;
+    price += ((int)(nextRand() % 11) - 5) * 0.5f;
+    statsPush(s, price, t);
+    assertVolatility();
+  }
+}
+
+void test_change_needs_history() {
+  for (int i = 0; i < 12; i++) {
+    statsPush(s, 100.0f + i, T0 + i * TICK_SECONDS);
+    TEST_ASSERT_FLOAT_IS_NAN(s.change1h);
+  }
+  statsPush(s, 112.0f, T0 + 12 * TICK_SECONDS);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 12.0f, s.change1h);
+  TEST_ASSERT_FLOAT_IS_NAN(s.change24h);
+}
+
+// Внеочередные тики не сдвигают горизонт 1 ч / 24 ч
+void test_extra_ticks_do_not_shift_horizons() {
+  PriceStats regular;
+  statsReset(regular);
+
+  uint32_t n = 24 * 3600 / TICK_SECONDS + 20;
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t t     = T0 + i * TICK_SECONDS;
+    float    price = 2000.0f + 50.0f * sinf(i * 0.05f) + i * 0.3f;
+    statsPush(regular, price, t);
+    statsPush(s, price, t);
+
+    // Refresh через минуту после тика, раз в 2 часа — в пределах HISTORY_SLACK за сутки
+    bool extra = i % 24 == 5;
+    if (extra) statsPush(s, price + 7.0f, t + 60);
+
+    if (extra) continue;  // сравниваем после обычного тика
+    TEST_ASSERT_EQUAL(isnan(regular.change1h), isnan(s.change1h));
+    if (!isnan(regular.change1h)) TEST_ASSERT_FLOAT_WITHIN(1e-5f, regular.change1h, s.change1h);
+    TEST_ASSERT_EQUAL(isnan(regular.change24h), isnan(s.change24h));
+    if (!isnan(regular.change24h)) TEST_ASSERT_FLOAT_WITHIN(1e-5f, regular.change24h, s.change24h);
+  }
+  TEST_ASSERT_FALSE(isnan(s.change24h));
+}
+
+void test_change_matches_brute_force() {
+  uint32_t t = T0;
+  for (int i = 0; i < 2 * HISTORY_LEN; i++) {
+    t += nextRand() % 4 == 0 ? 5 + nextRand() % 120 : TICK_SECONDS;
+    statsPush(s, 100.0f + (nextRand() % 1000) * 0.1f, t);
+
+    float expected = bruteChange(3600);
+    TEST_ASSERT_EQUAL(isnan(expected), isnan(s.change1h));
+    if (!isnan(expected)) TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, s.change1h);
+  }
+}
+
+// Дыра больше четверти горизонта — изменения за 1 ч нет
+void test_change_gap_is_nan() {
+  for (int i = 0; i < 20; i++) statsPush(s, 100.0f, T0 + i * TICK_SECONDS);
+  TEST_ASSERT_FALSE(isnan(s.change1h));
+  statsPush(s, 110.0f, T0 + 19 * TICK_SECONDS + 7200);
+  TEST_ASSERT_FLOAT_IS_NAN(s.change1h);
+}
+
+// Ровный шаг: вес EMA ≈ 2/(N+1); внеочередной тик почти не двигает EMA
+void test_ema_weights_by_time() {
+  statsPush(s, 100.0f, T0);
+  statsPush(s, 200.0f, T0 + TICK_SECONDS);
+  for (int i = 0; i < EMA_COUNT; i++) {
+    float n = (float)EMA_PERIODS[i] / TICK_SECONDS;
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f + 100.0f * 2.0f / (n + 1), s.ema[i]);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, s.emaPrev[i]);
+  }
+
+  float before = s.ema[1];
+  statsPush(s, 300.0f, T0 + TICK_SECONDS + 2);
+  TEST_ASSERT_LESS_THAN(0.5f, s.ema[1] - before);
+}
+
+// Часы подвели назад — время точки не уходит раньше предыдущей
+void test_time_never_goes_back() {
+  statsPush(s, 1.0f, T0 + 600);
+  statsPush(s, 2.0f, T0 + 300);
+  TEST_ASSERT_EQUAL_UINT32(T0 + 600, statsTime(s, 0));
+  TEST_ASSERT_EQUAL_UINT32(T0 + 600, statsTime(s, 1));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, s.volatility);
+}
+
+// Точки до синхронизации SNTP (время 0) получают время синхронизации
+void test_fill_time_after_sync() {
+  statsPush(s, 1.0f, 0);
+  statsPush(s, 2.0f, 0);
+  statsFillTime(s, T0);
+  TEST_ASSERT_EQUAL_UINT32(T0, statsTime(s, 0));
+  TEST_ASSERT_EQUAL_UINT32(T0, statsTime(s, 1));
+
+  statsPush(s, 3.0f, T0 + TICK_SECONDS);
+  statsFillTime(s, T0 + 2 * TICK_SECONDS);   // уже синхронизированные не трогаются
+  TEST_ASSERT_EQUAL_UINT32(T0 + TICK_SECONDS, statsTime(s, 0));
+  TEST_ASSERT_EQUAL_UINT32(T0, statsTime(s, 2));
+
+  // Точка с настоящим временем пришла раньше синхронизации (снимок лидера,
+  // Refresh): старые точки не становятся новее неё, а суммы волатильности
+  // после заливки остаются согласованными
+  statsReset(s);
+  statsPush(s, 100.0f, 0);
+  statsPush(s, 101.0f, T0);
+  statsFillTime(s, T0 + 60);
+  TEST_ASSERT_EQUAL_UINT32(T0, statsTime(s, 1));
+  TEST_ASSERT_EQUAL_UINT32(T0, statsTime(s, 0));
+
+  PriceStats clean;
+  statsReset(clean);
+  statsPush(clean, 101.0f, T0);
+
+  float v = 101.0f;
+  for (int i = 1; i <= 36; i++) {
+    v *= (i % 2) ? 1.01f : 0.99f;
+    statsPush(s,     v, T0 + i * TICK_SECONDS);
+    statsPush(clean, v, T0 + i * TICK_SECONDS);
+    TEST_ASSERT_TRUE(s.retWeight >= 0);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, clean.volatility, s.volatility);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, s.volatility);
+}
+
+// Окно правила CHANGE — минуты, а не тики: Refresh его не укорачивает
+void test_alert_change_window_in_minutes() {
+  AlertRule rule = { ALERT_CHANGE, 0, 60, 5.0f };
+  TEST_ASSERT_TRUE(alertValid(rule));
+
+  float metric;
+  int   fired = 0;
+  for (int i = 0; i <= 12; i++) {
+    statsPush(s, 100.0f, T0 + i * TICK_SECONDS);
+    statsPush(s, 100.0f, T0 + i * TICK_SECONDS + 45);   // лишний тик
+    if (alertCheck(rule, s, metric)) fired++;
+  }
+  TEST_ASSERT_EQUAL(0, fired);
+
+  statsPush(s, 106.0f, T0 + 13 * TICK_SECONDS);
+  TEST_ASSERT_TRUE(alertCheck(rule, s, metric));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 6.0f, metric);
+
+  statsPush(s, 106.5f, T0 + 13 * TICK_SECONDS + 45);
+  TEST_ASSERT_FALSE(alertCheck(rule, s, metric));   // по фронту — один раз
+
+  rule.param = ALERT_CHANGE_MAX_MINUTES + 1;
+  TEST_ASSERT_FALSE(alertValid(rule));
+}
+
+// Уровень: пустое поле формы (0) для цены и nan/inf для любого типа не проходят
+void test_alert_level_validation() {
+  AlertRule rule = { ALERT_ABOVE, 0, 0, 0.0f };
+  TEST_ASSERT_FALSE(alertValid(rule));
+  rule.level = 65000.0f;
+  TEST_ASSERT_TRUE(alertValid(rule));
+  rule.level = INFINITY;
+  TEST_ASSERT_FALSE(alertValid(rule));
+
+  rule = { ALERT_BELOW, 1, 0, -5.0f };
+  TEST_ASSERT_FALSE(alertValid(rule));
+
+  rule = { ALERT_CHANGE, 0, 60, NAN };
+  TEST_ASSERT_FALSE(alertValid(rule));
+
+  rule = { ALERT_CROSS_EMA, 0, 1, 0.0f };   // уровень не нужен
+  TEST_ASSERT_TRUE(alertValid(rule));
+  rule.level = NAN;
+  TEST_ASSERT_FALSE(alertValid(rule));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_min_max_queues_match_brute_force);
+  RUN_TEST(test_min_max_monotonic_series);
+  RUN_TEST(test_volatility_regular_ticks);
+  RUN_TEST(test_volatility_irregular_ticks_match_brute_force);
+  RUN_TEST(test_volatility_burst_rebuilds_window);
+  RUN_TEST(test_change_needs_history);
+  RUN_TEST(test_extra_ticks_do_not_shift_horizons);
+  RUN_TEST(test_change_matches_brute_force);
+  RUN_TEST(test_change_gap_is_nan);
+  RUN_TEST(test_ema_weights_by_time);
+  RUN_TEST(test_time_never_goes_back);
+  RUN_TEST(test_fill_time_after_sync);
+  RUN_TEST(test_alert_change_window_in_minutes);
+  RUN_TEST(test_alert_level_validation);
+  return UNITY_END();
+}
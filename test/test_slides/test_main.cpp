@@ -0,0 +1,143 @@
+// Нативный тест отрисовки: каждый слайд рисуется в эмулятор кадра из
+// фиксированных данных и сравнивается с эталоном golden/<имя>.pbm.
+// Заодно замеряется время отрисовки каждого слайда.
+//
+//   pio test -e native -f test_slides
+//   UPDATE_GOLDEN=1 pio test -e native -f test_slides   # перезаписать эталоны
+
+#include <unity.h>
+#include <OledFrame.h>
+#include <slides.h>
+#include <bootImage.h>
+#include <string>
+
+static OledFrame  oled;
+static PriceStats crypto1Stats;
+static PriceStats crypto2Stats;
+static AlertRule  alertRule = { ALERT_ABOVE, 0, 0, 65000.0f };
+static SlideData  data;
+
+const uint32_t FIXTURE_START = 1700000000;   // 2023-11-14
+const int      FIXTURE_TICKS = 24 * 12 + 13;   // чуть больше суток по 5 минут
+
+// Бюджет на отрисовку кадра на хосте — ловит случайный O(истории) в слайдах
+const unsigned long DRAW_BUDGET_US = 20000;
+
+static std::string goldenPath(const char* name) {
+  std::string path = __FILE__;
+  path = path.substr(0, path.find_last_of("/\\") + 1);
+  return path + "golden/" + name + ".pbm";
+}
+
+// Сравнение с эталоном; при UPDATE_GOLDEN — перезапись эталона
+static void checkGolden(const char* name) {
+  std::string path = goldenPath(name);
+  if (getenv("UPDATE_GOLDEN")) {
+    TEST_ASSERT_TRUE_MESSAGE(oled.writePbm(path.c_str()), path.c_str());
+    return;
+  }
+
+  OledFrame golden;
+  TEST_ASSERT_TRUE_MESSAGE(golden.readPbm(path.c_str()), path.c_str());
+
+  int diff = 0;
+  for (int y = 0; y < OledFrame::H; y++) {
+    for (int x = 0; x < OledFrame::W; x++) {
+      if (oled.pixel(x, y) != golden.pixel(x, y)) diff++;
+    }
+  }
+  if (diff != 0) {
+    std::string actual = path + ".actual";
+    oled.writePbm(actual.c_str());
+    char msg[160];
+    snprintf(msg, sizeof(msg), "%s: %d pixels differ, see %s", name, diff, actual.c_str());
+    TEST_FAIL_MESSAGE(msg);
+  }
+}
+
+// Отрисовка + update() с замером, как displayData() на плате
+static void renderSlide(int slide, const char* name) {
+  uint32_t updatesBefore = oled.updates;
+
+  unsigned long startUs = micros();
+  drawSlide(oled, slide, data);
+  unsigned long drawnUs = micros();
+  oled.update();
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%-6s draw %4lu us, %4u px, %u bytes",
+           name, drawnUs - startUs, oled.lastPixels, (unsigned)oled.lastBytes);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_EQUAL_UINT32(updatesBefore + 1, oled.updates);
+  TEST_ASSERT_EQUAL_UINT32(OledFrame::FRAME_BYTES, oled.lastBytes);
+  TEST_ASSERT_EQUAL_UINT16(oled.litPixels(), oled.lastPixels);
+  TEST_ASSERT_LESS_THAN(DRAW_BUDGET_US, drawnUs - startUs);
+  checkGolden(name);
+}
+
+void setUp() {
+  // Детерминированная история чуть длиннее суток: медленная волна + шум
+  statsReset(crypto1Stats);
+  statsReset(crypto2Stats);
+  for (int i = 0; i < FIXTURE_TICKS; i++) {
+    uint32_t t = FIXTURE_START + i * 300;
+    statsPush(crypto1Stats, 64000.0f + 900.0f * sinf(i / 23.0f) + (i * 37 % 11) * 15.0f, t);
+    statsPush(crypto2Stats,  3400.0f +  60.0f * cosf(i / 17.0f) + (i * 53 % 7)  *  2.0f, t);
+  }
+
+  data.stats[0]    = &crypto1Stats;
+  data.stats[1]    = &crypto2Stats;
+  data.bases[0]    = "BTC";
+  data.bases[1]    = "ETH";
+  data.clock       = "13:37";
+  data.city        = "Hrodna";
+  data.haveWeather = true;
+  data.temperature = -3.4f;
+  data.weather     = "Clouds";
+  data.alert       = &alertRule;
+  data.alertPrice  = 65012.34f;
+}
+
+void tearDown() {}
+
+void test_slide_crypto1() { renderSlide(0, "slide0"); }
+void test_slide_crypto2() { renderSlide(1, "slide1"); }
+void test_slide_clock()   { renderSlide(2, "slide2"); }
+void test_slide_weather() { renderSlide(3, "slide3"); }
+void test_slide_chart()   { renderSlide(4, "slide4"); }
+void test_slide_stats()   { renderSlide(5, "slide5"); }
+void test_slide_alert()   { renderSlide(ALERT_SLIDE, "alert"); }
+
+// Сразу после старта: истории и погоды ещё нет
+void test_slides_without_data() {
+  statsReset(crypto1Stats);
+  statsReset(crypto2Stats);
+  data.haveWeather = false;
+  data.weather     = "";
+  renderSlide(0, "empty0");
+  renderSlide(3, "empty3");
+  renderSlide(4, "empty4");
+  renderSlide(5, "empty5");
+}
+
+void test_boot_image() {
+  oled.clear();
+  oled.drawBitmap(0, 0, BootImage_128x64, 128, 64, BITMAP_NORMAL, BUF_ADD);
+  oled.update();
+  checkGolden("boot");
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_slide_crypto1);
+  RUN_TEST(test_slide_crypto2);
+  RUN_TEST(test_slide_clock);
+  RUN_TEST(test_slide_weather);
+  RUN_TEST(test_slide_chart);
+  RUN_TEST(test_slide_stats);
+  RUN_TEST(test_slide_alert);
+  RUN_TEST(test_slides_without_data);
+  RUN_TEST(test_boot_image);
+  return UNITY_END();
+}